@@ -0,0 +1,258 @@
+//
+// Phonetic index whose oversized buckets are refined with extra Soundex digits.
+//
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "phonetic_index.hpp"
+#include "radix_sort.hpp"
+#include "soundex.hpp"
+#include "soundex_code.hpp"
+
+// A few four character codes hold a large share of all names. Here every bucket
+// larger than a threshold is split by the next digit of the longer Soundex code
+// (a packed BasicSoundex<20> code, cut at max_code_size), recursively, into a tree
+// whose nodes each cover a contiguous run of names: names are kept in order of their
+// longer code, so a node holds exactly the names whose code starts with the node's code.
+//
+// Probing with a name walks down to the smallest node its code reaches, which bounds
+// the probe cost by the threshold (unless the longest code is still too common).
+// Probing with a code only walks as deep as the code goes, so a four character code
+// still finds its whole original bucket, a superset of every refined node below it.
+class AdaptivePhoneticIndex
+{
+    static constexpr std::size_t BASE_SIZE{ 4 };
+    static constexpr std::size_t LONG_SIZE{ 20 };
+    static constexpr std::size_t DIGIT_VALUES{ 7 };
+    static constexpr std::uint32_t NO_CHILDREN{ 0xFFFFFFFFu };
+
+    using LongSoundex = BasicSoundex<LONG_SIZE>;
+    using LongCode = BasicSoundexCode<LONG_SIZE>;
+
+    struct Node
+    {
+        std::uint32_t begin;
+        std::uint32_t end;
+        std::uint32_t first_child; // Children for digits '0' to '6' follow each other
+    };
+
+public:
+    using Range = PhoneticIndex::Range;
+
+    struct Options
+    {
+        std::size_t max_bucket_size{ 1024 }; // Larger buckets are split
+        std::size_t max_code_size{ 8 };      // Codes are never extended past this
+        std::size_t thread_count{ 1 };
+    };
+
+    explicit AdaptivePhoneticIndex(const std::vector<std::string_view>& names)
+        : AdaptivePhoneticIndex(names, Options{})
+    {
+    }
+
+    AdaptivePhoneticIndex(const std::vector<std::string_view>& names, const Options& options) : options_{ options }
+    {
+        if (options_.max_code_size < BASE_SIZE || options_.max_code_size > LONG_SIZE)
+            throw std::invalid_argument("Codes are extended to between 4 and 20 characters");
+
+        auto valid = std::vector<std::uint8_t>(std::size(names));
+        auto all_codes = std::vector<SoundexCode>(std::size(names));
+        Parallel::ForEachChunk(std::size(names), options_.thread_count,
+                               [&](std::size_t, std::size_t begin, std::size_t end)
+                               {
+                                   for (auto i = begin; i < end; ++i)
+                                   {
+                                       const auto code = Soundex::TryEncodePacked(names[i]);
+                                       valid[i] = code.has_value();
+                                       all_codes[i] = code.value_or(SoundexCode{});
+                                   }
+                               });
+        auto codes = std::vector<SoundexCode>{};
+        for (std::size_t i = 0; i < std::size(names); ++i)
+        {
+            if (!valid[i])
+                continue;
+            ids_.push_back(static_cast<std::uint32_t>(i));
+            codes.push_back(all_codes[i]);
+        }
+        rejected_ = std::size(names) - std::size(ids_);
+        RadixSort::ParallelSortByCode(ids_, codes, options_.thread_count);
+
+        // One root per four character code, then the refined levels below them
+        nodes_.resize(SoundexCode::RANK_COUNT, Node{ 0, 0, NO_CHILDREN });
+        for (std::size_t i = 0; i < std::size(codes);)
+        {
+            const auto rank = codes[i].Rank();
+            auto end = i;
+            while (end < std::size(codes) && codes[end] == codes[i])
+                ++end;
+            nodes_[rank] = Node{ static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(end), NO_CHILDREN };
+            if (end - i > options_.max_bucket_size && options_.max_code_size > BASE_SIZE)
+                Refine(rank, names);
+            i = end;
+        }
+
+        auto text_size = std::size_t{ 0 };
+        for (const auto id : ids_)
+            text_size += std::size(names[id]);
+        text_.reserve(text_size);
+        for (const auto id : ids_)
+            text_.append(names[id]);
+        auto position = std::size_t{ 0 };
+        for (const auto id : ids_)
+        {
+            names_.push_back(std::string_view{ text_ }.substr(position, std::size(names[id])));
+            position += std::size(names[id]);
+        }
+    }
+
+    AdaptivePhoneticIndex(const AdaptivePhoneticIndex&) = delete;
+    auto operator=(const AdaptivePhoneticIndex&) -> AdaptivePhoneticIndex& = delete;
+
+    auto Size() const -> std::size_t
+    {
+        return std::size(names_);
+    }
+
+    auto Rejected() const -> std::size_t
+    {
+        return rejected_;
+    }
+
+    // Names whose code matches name's as far as the index refines it; empty if name cannot be encoded
+    auto Probe(std::string_view name) const -> Range
+    {
+        const auto code = Soundex::TryEncodePacked(name);
+        if (!code.has_value())
+            return ToRange(Node{ 0, 0, NO_CHILDREN });
+        const auto node = nodes_[code->Rank()];
+        if (node.first_child == NO_CHILDREN)
+            return ToRange(node);
+        // Words have a longer code exactly when they have a four character one
+        auto long_code = LongCode{};
+        LongSoundex::EncodeInto(name, long_code);
+        return Descend(node, options_.max_code_size,
+                       [long_code](std::size_t position) { return DigitOf(long_code, position); });
+    }
+
+    // Names whose extended code starts with code, which has 4 or more characters
+    auto ProbeCode(std::string_view code) const -> Range
+    {
+        const auto node = nodes_[SoundexCode::FromString(code.substr(0, BASE_SIZE)).Rank()];
+        return Descend(node, std::size(code),
+                       [code](std::size_t position)
+                       {
+                           const auto digit = static_cast<std::size_t>(code[position] - '0');
+                           if (digit >= DIGIT_VALUES)
+                               throw std::runtime_error("Not a Soundex code: " + std::string{ code });
+                           return digit;
+                       });
+    }
+
+    // Size of the largest node a name probe can end up in
+    auto LargestProbe() const -> std::size_t
+    {
+        auto largest = std::size_t{ 0 };
+        for (const auto& node : nodes_)
+            if (node.first_child == NO_CHILDREN)
+                largest = std::max<std::size_t>(largest, node.end - node.begin);
+        return largest;
+    }
+
+    auto Id(const std::string_view* name) const -> std::uint32_t
+    {
+        return ids_[static_cast<std::size_t>(name - std::data(names_))];
+    }
+
+private:
+    auto ToRange(const Node& node) const -> Range
+    {
+        const auto* names = std::data(names_);
+        return Range{ names + node.begin, names + node.end };
+    }
+
+    // Digit at position, from 0, of a longer code
+    static auto DigitOf(LongCode code, std::size_t position) -> std::size_t
+    {
+        return (std::size_t{ code.Packed() } >> (3 * (LONG_SIZE - 1 - position))) & 0x7u;
+    }
+
+    // Walks down from node by the digits of a code of size characters, from the fifth
+    template <typename DigitAt>
+    auto Descend(Node node, std::size_t size, const DigitAt& digit_at) const -> Range
+    {
+        for (auto position = BASE_SIZE; position < size && node.first_child != NO_CHILDREN; ++position)
+            node = nodes_[node.first_child + digit_at(position)];
+        return ToRange(node);
+    }
+
+    // Orders the names of a root by their extended code and splits it level by level.
+    auto Refine(std::size_t root, const std::vector<std::string_view>& names) -> void
+    {
+        const auto [begin, end] = std::pair{ nodes_[root].begin, nodes_[root].end };
+        const auto extra_digits = options_.max_code_size - BASE_SIZE;
+        // The digits past the fourth of the longer code, cut at max_code_size
+        const auto unused_bits = 3 * (LONG_SIZE - options_.max_code_size);
+        const auto mask = (std::uint64_t{ 1 } << (3 * extra_digits)) - 1;
+        auto keyed = std::vector<std::pair<std::uint64_t, std::uint32_t>>{}; // Extra digits, id
+        keyed.reserve(end - begin);
+        for (auto i = begin; i < end; ++i)
+        {
+            auto code = LongCode{};
+            LongSoundex::EncodeInto(names[ids_[i]], code);
+            keyed.emplace_back((std::uint64_t{ code.Packed() } >> unused_bits) & mask, ids_[i]);
+        }
+        std::stable_sort(std::begin(keyed), std::end(keyed),
+                         [](const auto& lhs, const auto& rhs)
+                         {
+                             return lhs.first < rhs.first;
+                         });
+        for (auto i = begin; i < end; ++i)
+            ids_[i] = keyed[i - begin].second;
+
+        const auto digit_at = [&](std::uint32_t i, std::size_t depth)
+        {
+            return (keyed[i - begin].first >> (3 * (extra_digits - 1 - depth))) & 0x7u;
+        };
+        Split(root, 0, digit_at);
+    }
+
+    template <typename DigitAt>
+    auto Split(std::size_t node, std::size_t depth, const DigitAt& digit_at) -> void
+    {
+        const auto [begin, end] = std::pair{ nodes_[node].begin, nodes_[node].end };
+        if (end - begin <= options_.max_bucket_size || BASE_SIZE + depth >= options_.max_code_size)
+            return;
+        const auto first_child = std::size(nodes_);
+        nodes_[node].first_child = static_cast<std::uint32_t>(first_child);
+        auto child_begin = begin;
+        for (std::size_t digit = 0; digit < DIGIT_VALUES; ++digit)
+        {
+            auto child_end = child_begin;
+            while (child_end < end && digit_at(child_end, depth) == digit)
+                ++child_end;
+            nodes_.push_back(Node{ child_begin, child_end, NO_CHILDREN });
+            child_begin = child_end;
+        }
+        for (std::size_t digit = 0; digit < DIGIT_VALUES; ++digit)
+            Split(first_child + digit, depth + 1, digit_at);
+    }
+
+    Options options_;
+    std::string text_;
+    std::vector<std::string_view> names_; // In extended code order, viewing text_
+    std::vector<std::uint32_t> ids_;
+    std::vector<Node> nodes_; // Roots indexed by code rank, refined levels after them
+    std::size_t rejected_{ 0 };
+};
@@ -0,0 +1,164 @@
+//
+// Encoding a whole column of names at once.
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "phonetic_encoder.hpp"
+
+namespace BatchEncode
+{
+    // Codes of a column of names, stored contiguously: the codes of name i are
+    // codes[offsets[i]] to codes[offsets[i + 1]], none if it was rejected.
+    template <typename Code>
+    struct Column
+    {
+        std::vector<Code> codes;
+        std::vector<std::uint32_t> offsets;
+        std::size_t rejected{ 0 };
+
+        auto Size() const -> std::size_t
+        {
+            return std::size(offsets) - 1;
+        }
+
+        auto CodeCount(std::size_t name) const -> std::size_t
+        {
+            return offsets[name + 1] - offsets[name];
+        }
+
+        auto CodesOf(std::size_t name) const -> const Code*
+        {
+            return std::data(codes) + offsets[name];
+        }
+    };
+
+    namespace Detail
+    {
+        template <typename Fn, std::size_t... Indices>
+        auto ForEachIndex(Fn&& fn, std::index_sequence<Indices...>) -> void
+        {
+            (fn(std::integral_constant<std::size_t, Indices>{}), ...);
+        }
+    } // namespace Detail
+
+    // Encodes every name with each of Encoders (see phonetic_encoder.hpp) in a single
+    // pass over the names, so several keys can be built while each name is in cache,
+    // into columns, whose memory is reused: encoding names of the same count again
+    // on one thread does not allocate.
+    //
+    // Several threads encode chunks into their own buffers; the buffers are then
+    // concatenated in order, so the result does not depend on the thread count.
+    //
+    // Names are views of any character type the encoders read, so UTF-16 buffers
+    // from other runtimes are encoded where they are (Soundex reads them all, see
+    // unicode.hpp).
+    template <typename... Encoders, typename CharT>
+    auto EncodeColumnsInto(const std::vector<std::basic_string_view<CharT>>& names,
+                           std::tuple<Column<typename Encoders::Code>...>& columns, std::size_t thread_count = 1)
+        -> void
+    {
+        static_assert((PhoneticEncoder::IS_ENCODER<Encoders> && ...), "Not a phonetic encoder");
+        constexpr auto indices = std::index_sequence_for<Encoders...>{};
+        using EncoderTuple = std::tuple<Encoders...>;
+        Detail::ForEachIndex(
+            [&](auto index)
+            {
+                auto& column = std::get<index>(columns);
+                column.codes.clear();
+                column.offsets.assign(std::size(names) + 1, 0);
+                column.rejected = 0;
+            },
+            indices);
+
+        // Appends the codes of name i to codes_of(index) for each encoder
+        const auto encode = [&](std::size_t i, auto codes_of)
+        {
+            Detail::ForEachIndex(
+                [&](auto index)
+                {
+                    using Encoder = std::tuple_element_t<index, EncoderTuple>;
+                    auto buffer = std::array<typename Encoder::Code, Encoder::MAX_CODES>{};
+                    const auto count = Encoder::EncodeAll(names[i], std::data(buffer));
+                    auto& codes = codes_of(index);
+                    codes.insert(std::end(codes), std::begin(buffer),
+                                 std::begin(buffer) + static_cast<std::ptrdiff_t>(count));
+                    std::get<index>(columns).offsets[i + 1] = static_cast<std::uint32_t>(count);
+                },
+                indices);
+        };
+
+        const auto chunk_count = Parallel::ThreadCount(thread_count);
+        if (chunk_count == 1)
+        {
+            for (std::size_t i = 0; i < std::size(names); ++i)
+                encode(i, [&](auto index) -> auto& { return std::get<index>(columns).codes; });
+        }
+        else
+        {
+            auto chunk_codes = std::tuple<std::vector<std::vector<typename Encoders::Code>>...>{
+                std::vector<std::vector<typename Encoders::Code>>(chunk_count)...
+            };
+            Parallel::ForEachChunk(
+                std::size(names), thread_count,
+                [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                {
+                    Detail::ForEachIndex([&](auto index) { std::get<index>(chunk_codes)[chunk].reserve(end - begin); },
+                                         indices);
+                    for (auto i = begin; i < end; ++i)
+                        encode(i, [&](auto index) -> auto& { return std::get<index>(chunk_codes)[chunk]; });
+                });
+            Detail::ForEachIndex(
+                [&](auto index)
+                {
+                    auto& column = std::get<index>(columns);
+                    auto size = std::size_t{ 0 };
+                    for (const auto& codes : std::get<index>(chunk_codes))
+                        size += std::size(codes);
+                    column.codes.reserve(size);
+                    for (const auto& codes : std::get<index>(chunk_codes))
+                        column.codes.insert(std::end(column.codes), std::begin(codes), std::end(codes));
+                },
+                indices);
+        }
+
+        Detail::ForEachIndex(
+            [&](auto index)
+            {
+                auto& column = std::get<index>(columns);
+                for (std::size_t i = 0; i < std::size(names); ++i)
+                {
+                    if (column.offsets[i + 1] == 0)
+                        ++column.rejected;
+                    column.offsets[i + 1] += column.offsets[i];
+                }
+            },
+            indices);
+    }
+
+    // Same as EncodeColumnsInto, into new columns
+    template <typename... Encoders, typename CharT>
+    auto EncodeColumns(const std::vector<std::basic_string_view<CharT>>& names, std::size_t thread_count = 1)
+        -> std::tuple<Column<typename Encoders::Code>...>
+    {
+        auto columns = std::tuple<Column<typename Encoders::Code>...>{};
+        EncodeColumnsInto<Encoders...>(names, columns, thread_count);
+        return columns;
+    }
+
+    // Encodes every name with Encoder
+    template <typename Encoder, typename CharT>
+    auto EncodeColumn(const std::vector<std::basic_string_view<CharT>>& names, std::size_t thread_count = 1)
+        -> Column<typename Encoder::Code>
+    {
+        return std::get<0>(EncodeColumns<Encoder>(names, thread_count));
+    }
+} // namespace BatchEncode
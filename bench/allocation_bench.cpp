@@ -0,0 +1,189 @@
+//
+// Heap allocations and time per name of the legacy Soundex::Encode, with the
+// Helpers it used before they became string_view functions and with the current
+// ones.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../soundex.hpp"
+
+namespace
+{
+    std::size_t allocations{ 0 };
+} // namespace
+
+// Not inlined, so the compiler does not pair malloc and free across them
+[[gnu::noinline]] auto operator new(std::size_t size) -> void*
+{
+    ++allocations;
+    if (auto* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] auto operator delete(void* memory) noexcept -> void
+{
+    std::free(memory);
+}
+
+[[gnu::noinline]] auto operator delete(void* memory, std::size_t) noexcept -> void
+{
+    std::free(memory);
+}
+
+namespace
+{
+    // Soundex::Encode as it was, with Helpers returning new strings and vectors
+    namespace Before
+    {
+        auto Head(const std::string& word) -> std::string
+        {
+            return word.substr(0, 1);
+        }
+
+        auto Tail(const std::string& word) -> std::string
+        {
+            return word.substr(1);
+        }
+
+        auto ToUppercase(const std::string& word) -> std::string
+        {
+            return std::string(1, static_cast<char>(std::toupper(static_cast<unsigned char>(word.front()))));
+        }
+
+        auto IsConsonant(char letter) -> bool
+        {
+            letter = static_cast<char>(std::tolower(letter));
+            const auto vowels = std::vector<char>{ 'a', 'e', 'i', 'o', 'u' };
+            return std::find(std::begin(vowels), std::end(vowels), tolower(letter)) == std::end(vowels);
+        }
+
+        auto IsVowel(char letter) -> bool
+        {
+            return !IsConsonant(letter);
+        }
+
+        auto ConsonantShouldBeIgnored(const char letter) -> bool
+        {
+            const auto ignored_consonants = std::vector<char>{ 'w', 'h', 'y', 'W', 'H', 'Y' };
+            return std::find(std::begin(ignored_consonants), std::end(ignored_consonants), letter) !=
+                   std::end(ignored_consonants);
+        }
+
+        auto PadWithZeros(const std::string& word, std::size_t desired_size) -> std::string
+        {
+            const auto zeros_needed = desired_size - word.length();
+            return std::string{ word } + std::string(zeros_needed, '0');
+        }
+
+        auto EncodeDigit(char letter) -> std::optional<char>
+        {
+            // clang-format off
+            const static std::unordered_map<char, char> encodings
+                {
+                    { 'b', '1' }, { 'f', '1' }, { 'p', '1' }, { 'v', '1' },
+                    { 'c', '2' }, { 'g', '2' }, { 'j', '2' }, { 'k', '2' }, { 'q', '2' },
+                    { 's', '2' }, { 'x', '2' }, { 'z', '2'},
+                    { 'd', '3' }, { 't', '3' },
+                    { 'l', '4' },
+                    { 'm', '5' }, { 'n', '5' },
+                    { 'r', '6' },
+                };
+            // clang-format on
+            const auto& item = encodings.find(static_cast<char>(tolower(letter)));
+            if (item == std::end(encodings))
+                return std::nullopt;
+            return item->second;
+        }
+
+        auto EncodeDigits(const std::string& word, std::size_t size) -> std::string
+        {
+            auto digits = std::string{};
+            digits.push_back(EncodeDigit(word.front()).value_or('*'));
+            auto last_letter = char{ '*' };
+            auto encoded_consonants = std::size_t{ 0 };
+            for (const auto& letter : Tail(word))
+            {
+                if (IsConsonant(letter) && !ConsonantShouldBeIgnored(letter))
+                {
+                    const auto to_encode = EncodeDigit(letter);
+                    if (!to_encode.has_value())
+                    {
+                        last_letter = letter;
+                        continue;
+                    }
+                    const auto value = to_encode.value();
+                    if (value != digits.back() || IsVowel(last_letter))
+                    {
+                        digits.push_back(value);
+                        ++encoded_consonants;
+                    }
+                }
+                last_letter = letter;
+                if (encoded_consonants + 1 == size)
+                    break;
+            }
+            return digits;
+        }
+
+        auto Encode(const std::string& word) -> std::string
+        {
+            const auto encoding = ToUppercase(Head(word)) + Tail(EncodeDigits(word, 4));
+            return PadWithZeros(encoding, 4);
+        }
+    } // namespace Before
+
+    struct Result
+    {
+        double allocations_per_name;
+        double ns_per_name;
+    };
+
+    template <typename Encode>
+    auto Measure(const std::vector<std::string>& names, std::size_t rounds, Encode encode) -> Result
+    {
+        auto checksum = std::size_t{ 0 };
+        const auto allocations_before = allocations;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t round = 0; round < rounds; ++round)
+            for (const auto& name : names)
+                checksum += static_cast<unsigned char>(encode(name).back());
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const auto count = static_cast<double>(rounds * std::size(names));
+        if (checksum == 0)
+            std::puts("");
+        return { static_cast<double>(allocations - allocations_before) / count,
+                 static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / count };
+    }
+} // namespace
+
+auto main() -> int
+{
+    const auto short_names =
+        std::vector<std::string>{ "Robert", "Rupert", "Rubin", "Ashcraft", "Tymczak", "Pfister", "Lee", "Gutierrez" };
+    const auto long_names = std::vector<std::string>{ "Wolfeschlegelsteinhausenbergerdorff", "Featherstonehaughsmythe",
+                                                      "Vanderbiltmontgomery", "Oppenheimerlichtenstein" };
+    constexpr auto ROUNDS = std::size_t{ 200000 };
+
+    // Warm the static tables up first
+    Before::Encode("Robert");
+    Soundex::Encode("Robert");
+
+    std::printf("%-8s %-9s %14s %12s\n", "names", "helpers", "allocs/name", "ns/name");
+    for (const auto& [label, names] : { std::pair{ "short", &short_names }, std::pair{ "long", &long_names } })
+    {
+        const auto before = Measure(*names, ROUNDS, Before::Encode);
+        const auto after = Measure(*names, ROUNDS, Soundex::Encode);
+        std::printf("%-8s %-9s %14.2f %12.1f\n", label, "string", before.allocations_per_name, before.ns_per_name);
+        std::printf("%-8s %-9s %14.2f %12.1f\n", label, "view", after.allocations_per_name, after.ns_per_name);
+    }
+}
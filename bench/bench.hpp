@@ -0,0 +1,361 @@
+//
+// Small harness shared by the benchmarks: timing, hardware counters, keeping results
+// alive, and JSON output.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Bench
+{
+    // Makes the compiler assume value is read, so the work producing it is kept
+    template <typename T>
+    auto DoNotOptimize(const T& value) -> void
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    inline auto SecondsSince(Clock::time_point start) -> double
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // A cheap, monotonic tick count for timing single calls: the time stamp counter on
+    // x86, the virtual counter on AArch64, nanoseconds of Clock elsewhere. The fence
+    // keeps the read from starting before the instructions in front of it complete.
+    inline auto Ticks() -> std::uint64_t
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        return __rdtsc();
+#elif defined(__aarch64__)
+        auto ticks = std::uint64_t{};
+        asm volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Ticks per nanosecond, measured against Clock over about 50 ms
+    inline auto TicksPerNanosecond() -> double
+    {
+        const auto start = Clock::now();
+        const auto first = Ticks();
+        while (Clock::now() - start < std::chrono::milliseconds{ 50 })
+        {
+        }
+        const auto ticks = static_cast<double>(Ticks() - first);
+        return ticks / std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    // Median seconds per call of fn over repetitions calls, after one warm up call
+    template <typename Fn>
+    auto MedianSeconds(std::size_t repetitions, Fn fn) -> double
+    {
+        fn();
+        auto seconds = std::vector<double>{};
+        for (std::size_t i = 0; i < repetitions; ++i)
+        {
+            const auto start = Clock::now();
+            fn();
+            seconds.push_back(SecondsSince(start));
+        }
+        std::sort(std::begin(seconds), std::end(seconds));
+        return seconds[std::size(seconds) / 2];
+    }
+
+    // Histogram of latencies in the style of HdrHistogram: values below 2^BITS have a
+    // bucket each, and above that every power of two is split into 2^(BITS - 1)
+    // buckets, so a percentile is off by less than 2^(1 - BITS) of its value whatever
+    // the range, with a few thousand counters.
+    class LatencyHistogram
+    {
+        static constexpr unsigned BITS{ 8 };
+        static constexpr std::uint64_t EXACT{ std::uint64_t{ 1 } << BITS };
+        static constexpr std::uint64_t HALF{ EXACT / 2 };
+
+    public:
+        LatencyHistogram() : counts_((64 - BITS + 2) * HALF)
+        {
+        }
+
+        auto Record(std::uint64_t value) -> void
+        {
+            ++counts_[Index(value)];
+            ++count_;
+            sum_ += static_cast<double>(value);
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        auto Count() const -> std::uint64_t
+        {
+            return count_;
+        }
+
+        auto Min() const -> std::uint64_t
+        {
+            return count_ == 0 ? 0 : min_;
+        }
+
+        auto Max() const -> std::uint64_t
+        {
+            return max_;
+        }
+
+        auto Mean() const -> double
+        {
+            return count_ == 0 ? 0.0 : sum_ / static_cast<double>(count_);
+        }
+
+        // Smallest recorded value such that percentile % of the values are at most it,
+        // up to the bucket width
+        auto Percentile(double percentile) const -> std::uint64_t
+        {
+            const auto rank = std::max<std::uint64_t>(
+                1, static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count_))));
+            auto seen = std::uint64_t{ 0 };
+            for (std::size_t index = 0; index < std::size(counts_); ++index)
+            {
+                seen += counts_[index];
+                if (seen >= rank)
+                    return std::min(HighestInBucket(index), max_);
+            }
+            return max_;
+        }
+
+    private:
+        static auto Index(std::uint64_t value) -> std::size_t
+        {
+            if (value < EXACT)
+                return value;
+            const auto shift = static_cast<unsigned>(63 - __builtin_clzll(value)) - BITS + 1;
+            return shift * HALF + (value >> shift);
+        }
+
+        static auto HighestInBucket(std::size_t index) -> std::uint64_t
+        {
+            if (index < EXACT)
+                return index;
+            const auto shift = index / HALF - 1;
+            return ((index - shift * HALF) << shift) + (std::uint64_t{ 1 } << shift) - 1;
+        }
+
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t count_{ 0 };
+        double sum_{ 0.0 };
+        std::uint64_t min_{ ~std::uint64_t{ 0 } };
+        std::uint64_t max_{ 0 };
+    };
+
+    // Hardware counters of the calling thread, from perf_event_open on Linux, counting
+    // user space only. Each event is opened on its own, so the ones the machine or the
+    // kernel refuse (virtual machines, containers, perf_event_paranoid above 2) are
+    // just missing; elsewhere than Linux all of them are.
+    class Counters
+    {
+    public:
+        enum Event
+        {
+            CYCLES,
+            INSTRUCTIONS,
+            BRANCH_MISSES,
+            CACHE_MISSES,
+            EVENT_COUNT
+        };
+
+        static constexpr std::array<const char*, EVENT_COUNT> NAMES{ "cycles", "instructions", "branch_misses",
+                                                                     "cache_misses" };
+
+        // Counts of a measurement, scaled up when the kernel multiplexed the counter
+        using Counts = std::array<std::optional<double>, EVENT_COUNT>;
+
+        Counters()
+        {
+#if defined(__linux__)
+            constexpr std::array<std::uint64_t, EVENT_COUNT> CONFIGS{ PERF_COUNT_HW_CPU_CYCLES,
+                                                                      PERF_COUNT_HW_INSTRUCTIONS,
+                                                                      PERF_COUNT_HW_BRANCH_MISSES,
+                                                                      PERF_COUNT_HW_CACHE_MISSES };
+            for (std::size_t event = 0; event < EVENT_COUNT; ++event)
+            {
+                auto attributes = perf_event_attr{};
+                attributes.size = sizeof(attributes);
+                attributes.type = PERF_TYPE_HARDWARE;
+                attributes.config = CONFIGS[event];
+                attributes.disabled = 1;
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+                attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                descriptors_[event] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+            }
+#endif
+        }
+
+        Counters(const Counters&) = delete;
+        auto operator=(const Counters&) -> Counters& = delete;
+
+        ~Counters()
+        {
+#if defined(__linux__)
+            for (const auto descriptor : descriptors_)
+                if (descriptor >= 0)
+                    close(descriptor);
+#endif
+        }
+
+        auto Available(Event event) const -> bool
+        {
+            return descriptors_[event] >= 0;
+        }
+
+        auto AnyAvailable() const -> bool
+        {
+            return std::any_of(std::begin(descriptors_), std::end(descriptors_), [](int fd) { return fd >= 0; });
+        }
+
+        // Counts of the events during fn()
+        template <typename Fn>
+        auto Measure(Fn fn) -> Counts
+        {
+#if defined(__linux__)
+            for (const auto descriptor : descriptors_)
+            {
+                if (descriptor >= 0)
+                {
+                    ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+            fn();
+            for (const auto descriptor : descriptors_)
+                if (descriptor >= 0)
+                    ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+
+            auto counts = Counts{};
+            for (std::size_t event = 0; event < EVENT_COUNT; ++event)
+            {
+                // Value, time enabled, time running
+                auto values = std::array<std::uint64_t, 3>{};
+                if (descriptors_[event] < 0 ||
+                    read(descriptors_[event], std::data(values), sizeof(values)) != sizeof(values) || values[2] == 0)
+                    continue;
+                counts[event] =
+                    static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]);
+            }
+            return counts;
+#else
+            fn();
+            return {};
+#endif
+        }
+
+    private:
+        std::array<int, EVENT_COUNT> descriptors_{ -1, -1, -1, -1 };
+    };
+
+    // Writes one JSON object per result into a "results" array:
+    //
+    //   { "benchmark": "...", "results": [ { "key": value, ... }, ... ] }
+    class JsonWriter
+    {
+    public:
+        JsonWriter(std::ostream& out, std::string_view benchmark) : out_{ out }
+        {
+            out_ << "{\n  \"benchmark\": " << Quoted(benchmark) << ",\n  \"results\": [";
+        }
+
+        JsonWriter(const JsonWriter&) = delete;
+        auto operator=(const JsonWriter&) -> JsonWriter& = delete;
+
+        ~JsonWriter()
+        {
+            out_ << (results_ == 0 ? "]\n}\n" : " }\n  ]\n}\n");
+        }
+
+        // Starts a result; fields are added to it until the next one
+        auto Result() -> JsonWriter&
+        {
+            out_ << (results_++ == 0 ? "\n    {" : " },\n    {");
+            fields_ = 0;
+            return *this;
+        }
+
+        auto Field(std::string_view key, std::string_view value) -> JsonWriter&
+        {
+            return Raw(key, Quoted(value));
+        }
+
+        auto Field(std::string_view key, const char* value) -> JsonWriter&
+        {
+            return Raw(key, Quoted(value));
+        }
+
+        auto Field(std::string_view key, double value) -> JsonWriter&
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+            return Raw(key, buffer);
+        }
+
+        auto Field(std::string_view key, std::uint64_t value) -> JsonWriter&
+        {
+            return Raw(key, std::to_string(value));
+        }
+
+        auto Field(std::string_view key, bool value) -> JsonWriter&
+        {
+            return Raw(key, value ? "true" : "false");
+        }
+
+    private:
+        auto Raw(std::string_view key, std::string_view value) -> JsonWriter&
+        {
+            out_ << (fields_++ == 0 ? " " : ", ") << Quoted(key) << ": " << value;
+            return *this;
+        }
+
+        static auto Quoted(std::string_view text) -> std::string
+        {
+            auto quoted = std::string{ "\"" };
+            for (const auto c : text)
+            {
+                if (c == '"' || c == '\\')
+                    quoted.push_back('\\');
+                quoted.push_back(c);
+            }
+            quoted.push_back('"');
+            return quoted;
+        }
+
+        std::ostream& out_;
+        std::size_t results_{ 0 };
+        std::size_t fields_{ 0 };
+    };
+} // namespace Bench
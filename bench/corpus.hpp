@@ -0,0 +1,485 @@
+//
+// Reproducible synthetic surname corpora for the benchmarks.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "../parallel.hpp"
+
+// A vocabulary of distinct surname-like names is built once from syllables, with
+// lengths drawn from the length distribution of real surnames. Names are then drawn
+// from it with Zipfian frequencies (rank r has weight 1 / r^exponent) through an
+// alias table, and a drawn name is replaced, at the configured rates, by its
+// invalid, accented or hyphenated variant, also built up front. Drawing a name is
+// thus two random numbers and a copy, and names are generated in fixed blocks,
+// each with its own random stream, so blocks run on any number of threads and the
+// corpus only depends on the options.
+namespace Corpus
+{
+    struct Options
+    {
+        std::uint64_t seed{ 1 };
+        std::size_t vocabulary{ std::size_t{ 1 } << 16 };
+        double zipf_exponent{ 1.0 };
+        // Weight of each name length, from 0; roughly the lengths of US census surnames
+        std::vector<double> length_weights{ 0, 0, 0.3, 2.5, 8, 16, 21, 19, 14, 9, 5, 2.5, 1.2, 0.6, 0.3, 0.2 };
+        // Fractions of the names drawn that are replaced by a variant
+        double invalid_rate{ 0.0 };
+        double accented_rate{ 0.0 };
+        double hyphenated_rate{ 0.0 };
+    };
+
+    // Names stored back to back; name i is buffer[offsets[i]] to buffer[offsets[i + 1]]
+    struct Names
+    {
+        std::string buffer;
+        std::vector<std::uint64_t> offsets{ 0 };
+
+        auto Size() const -> std::size_t
+        {
+            return std::size(offsets) - 1;
+        }
+
+        auto operator[](std::size_t i) const -> std::string_view
+        {
+            return { std::data(buffer) + offsets[i], offsets[i + 1] - offsets[i] };
+        }
+
+        // Views of the names, valid as long as the buffer is not changed
+        auto Views() const -> std::vector<std::string_view>
+        {
+            auto views = std::vector<std::string_view>{};
+            views.reserve(Size());
+            for (std::size_t i = 0; i < Size(); ++i)
+                views.push_back((*this)[i]);
+            return views;
+        }
+    };
+
+    namespace Detail
+    {
+        // SplitMix64: small, fast and good enough to draw names
+        class Random
+        {
+        public:
+            explicit Random(std::uint64_t seed) : state_{ seed }
+            {
+            }
+
+            auto Next() -> std::uint64_t
+            {
+                auto z = (state_ += 0x9E3779B97F4A7C15u);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+                return z ^ (z >> 31);
+            }
+
+            // Uniform in [0, 1), from the top 53 bits
+            auto Uniform() -> double
+            {
+                return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+            }
+
+            // Uniform in [0, bound)
+            auto Below(std::size_t bound) -> std::size_t
+            {
+                return static_cast<std::size_t>(Uniform() * static_cast<double>(bound));
+            }
+
+        private:
+            std::uint64_t state_;
+        };
+
+        // Vose's alias method: draws index i with probability weights[i] / sum from
+        // one random number. The top bits pick an entry, the low bits choose between
+        // its own index and its alias, so a draw is one memory access and no branch.
+        class AliasTable
+        {
+        public:
+            explicit AliasTable(const std::vector<double>& weights) : entries_(std::size(weights))
+            {
+                if (weights.empty() || std::size(weights) > 0xFFFFFFFFu)
+                    throw std::invalid_argument("Sampling needs between 1 and 2^32 - 1 weights");
+                auto sum = 0.0;
+                for (const auto weight : weights)
+                    sum += weight;
+                const auto count = std::size(weights);
+                auto scaled = std::vector<double>(count);
+                auto small = std::vector<std::uint32_t>{};
+                auto large = std::vector<std::uint32_t>{};
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    scaled[i] = weights[i] * static_cast<double>(count) / sum;
+                    (scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+                }
+                while (!small.empty() && !large.empty())
+                {
+                    const auto less = small.back();
+                    const auto more = large.back();
+                    small.pop_back();
+                    entries_[less] = { Threshold(scaled[less]), more };
+                    scaled[more] -= 1.0 - scaled[less];
+                    if (scaled[more] < 1.0)
+                    {
+                        large.pop_back();
+                        small.push_back(more);
+                    }
+                }
+                // What is left has probability 1 up to rounding
+                for (const auto i : large)
+                    entries_[i] = { 0xFFFFFFFFu, i };
+                for (const auto i : small)
+                    entries_[i] = { 0xFFFFFFFFu, i };
+            }
+
+            auto Draw(Random& random) const -> std::size_t
+            {
+                const auto bits = random.Next();
+                const auto index = ((bits >> 32) * std::size(entries_)) >> 32;
+                const auto& entry = entries_[index];
+                return static_cast<std::uint32_t>(bits) < entry.threshold ? index : entry.alias;
+            }
+
+        private:
+            struct Entry
+            {
+                std::uint32_t threshold;
+                std::uint32_t alias;
+            };
+
+            static auto Threshold(double probability) -> std::uint32_t
+            {
+                return static_cast<std::uint32_t>(probability * 4294967296.0);
+            }
+
+            std::vector<Entry> entries_;
+        };
+
+        inline constexpr std::string_view SYLLABLES[] = {
+            "an",  "ber", "bra", "car", "chen", "da",  "del", "dor", "el",  "er",  "fer", "gar", "gon", "ham",
+            "har", "hol", "in",  "jo",  "ka",   "kow", "la",  "le",  "lin", "lo",  "ma",  "mar", "mc",  "mil",
+            "mo",  "na",  "ne",  "ni",  "no",   "o",   "ov",  "pa",  "per", "ra",  "ri",  "ro",  "san", "sch",
+            "se",  "ski", "son", "sta", "ste",  "ta",  "ter", "ton", "tr",  "u",   "va",  "ver", "wa",  "wil",
+            "win", "ya",  "ze",  "zy",  "ck",   "ley", "man", "ez",  "is",  "us",  "berg", "stein"
+        };
+
+        // Accented forms of ASCII letters, in UTF-8
+        inline auto Accented(char letter) -> std::string_view
+        {
+            switch (letter)
+            {
+            case 'a':
+                return "á";
+            case 'c':
+                return "ç";
+            case 'e':
+                return "é";
+            case 'i':
+                return "í";
+            case 'l':
+                return "ł";
+            case 'n':
+                return "ñ";
+            case 'o':
+                return "ö";
+            case 's':
+                return "š";
+            case 'u':
+                return "ü";
+            case 'z':
+                return "ż";
+            default:
+                return {};
+            }
+        }
+
+        // Copies name to out and returns its end. Short names are copied as 16 bytes,
+        // past their end, so both buffers need Generator::PADDING bytes of slack.
+        inline auto CopyName(char* out, std::string_view name) -> char*
+        {
+            if (std::size(name) <= 16)
+                std::memcpy(out, std::data(name), 16);
+            else
+                std::memcpy(out, std::data(name), std::size(name));
+            return out + std::size(name);
+        }
+    } // namespace Detail
+
+    class Generator
+    {
+    public:
+        // Names per block of the random streams
+        static constexpr std::size_t BLOCK_SIZE{ 4096 };
+        // Bytes after the names the generator hands out that may be read
+        static constexpr std::size_t PADDING{ 16 };
+
+        explicit Generator(const Options& options)
+            : options_{ options }, ranks_{ ZipfRanks(options) }, block_seed_{ options.seed ^ 0x5DEECE66Du }
+        {
+            if (options.invalid_rate + options.accented_rate + options.hyphenated_rate > 1.0)
+                throw std::invalid_argument("The variant rates add up to more than 1");
+            BuildVocabulary();
+        }
+
+        // Calls fn(name) for the names of block, from name BLOCK_SIZE * block up to
+        // name name_count
+        template <typename Fn>
+        auto ForEachName(std::size_t block, std::size_t name_count, Fn fn) const -> void
+        {
+            auto random = Detail::Random{ block_seed_ + block * 0xD1B54A32D192ED03u };
+            const auto end = std::min(name_count, (block + 1) * BLOCK_SIZE);
+            for (auto i = block * BLOCK_SIZE; i < end; ++i)
+                fn(Draw(random));
+        }
+
+        // The first count names of the corpus
+        auto Generate(std::size_t count, std::size_t thread_count = 1) const -> Names
+        {
+            const auto block_count = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            auto parts = std::vector<Names>(Parallel::ThreadCount(thread_count));
+            Parallel::ForEachChunk(block_count, thread_count,
+                                   [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                                   {
+                                       auto& part = parts[chunk];
+                                       part.offsets.reserve((end - begin) * BLOCK_SIZE + 1);
+                                       const auto add = [&part](std::string_view name) { Add(part, name); };
+                                       for (auto block = begin; block < end; ++block)
+                                           ForEachName(block, count, add);
+                                   });
+            auto names = std::move(parts.front());
+            for (std::size_t i = 1; i < std::size(parts); ++i)
+            {
+                const auto base = std::size(names.buffer);
+                names.buffer += parts[i].buffer;
+                for (std::size_t j = 1; j < std::size(parts[i].offsets); ++j)
+                    names.offsets.push_back(base + parts[i].offsets[j]);
+            }
+            return names;
+        }
+
+        // Distinct names the corpus draws from, most frequent first
+        auto Vocabulary() const -> const Names&
+        {
+            return plain_;
+        }
+
+        // Bytes in the longest name drawn
+        auto MaxNameSize() const -> std::size_t
+        {
+            return max_name_size_;
+        }
+
+        static auto Add(Names& names, std::string_view name) -> void
+        {
+            names.buffer += name;
+            names.offsets.push_back(std::size(names.buffer));
+        }
+
+    private:
+        static auto ZipfRanks(const Options& options) -> Detail::AliasTable
+        {
+            if (options.vocabulary == 0 || options.vocabulary > 0xFFFFFFFFu)
+                throw std::invalid_argument("The vocabulary needs between 1 and 2^32 - 1 names");
+            auto weights = std::vector<double>(options.vocabulary);
+            for (std::size_t rank = 0; rank < options.vocabulary; ++rank)
+                weights[rank] = std::pow(static_cast<double>(rank + 1), -options.zipf_exponent);
+            return Detail::AliasTable{ weights };
+        }
+
+        auto BuildVocabulary() -> void
+        {
+            auto random = Detail::Random{ options_.seed };
+            const auto lengths = Detail::AliasTable{ options_.length_weights };
+            auto seen = std::unordered_set<std::string>{};
+            for (std::size_t attempt = 0; plain_.Size() < options_.vocabulary; ++attempt)
+            {
+                const auto length = std::max<std::size_t>(1, lengths.Draw(random));
+                auto name = std::string{};
+                while (std::size(name) < length)
+                    name += Detail::SYLLABLES[random.Below(std::size(Detail::SYLLABLES))];
+                name.resize(length);
+                name.front() = static_cast<char>(name.front() - 'a' + 'A');
+                // Short lengths have few distinct names; past enough attempts, repeat them
+                if (seen.insert(name).second || attempt > 64 * options_.vocabulary)
+                    Add(plain_, name);
+            }
+
+            for (std::size_t i = 0; i < plain_.Size(); ++i)
+            {
+                const auto name = std::string{ plain_[i] };
+                Add(invalid_, Invalid(name, random));
+                Add(accented_, AccentedForm(name, random));
+                Add(hyphenated_, name + '-' + std::string{ plain_[random.Below(plain_.Size())] });
+            }
+
+            for (auto* names : { &plain_, &invalid_, &accented_, &hyphenated_ })
+            {
+                for (std::size_t i = 0; i < names->Size(); ++i)
+                    max_name_size_ = std::max(max_name_size_, std::size((*names)[i]));
+                names->buffer.append(PADDING, '\0');
+            }
+        }
+
+        // O'Name, Name2, Van Name or Na.me
+        static auto Invalid(const std::string& name, Detail::Random& random) -> std::string
+        {
+            switch (random.Below(4))
+            {
+            case 0:
+                return name.substr(0, 1) + '\'' + name;
+            case 1:
+                return name + static_cast<char>('0' + random.Below(10));
+            case 2:
+                return "Van " + name;
+            default:
+                return name.substr(0, 1) + '.' + name.substr(1);
+            }
+        }
+
+        // One letter past the first accented, if the name has one that can be
+        static auto AccentedForm(const std::string& name, Detail::Random& random) -> std::string
+        {
+            auto candidates = std::vector<std::size_t>{};
+            for (std::size_t i = 1; i < std::size(name); ++i)
+                if (!Detail::Accented(name[i]).empty())
+                    candidates.push_back(i);
+            if (candidates.empty())
+                return name;
+            const auto i = candidates[random.Below(std::size(candidates))];
+            return name.substr(0, i) + std::string{ Detail::Accented(name[i]) } + name.substr(i + 1);
+        }
+
+        auto Draw(Detail::Random& random) const -> std::string_view
+        {
+            const auto rank = ranks_.Draw(random);
+            if (options_.invalid_rate + options_.accented_rate + options_.hyphenated_rate == 0.0)
+                return plain_[rank];
+            auto variant = random.Uniform();
+            if (variant < options_.invalid_rate)
+                return invalid_[rank];
+            variant -= options_.invalid_rate;
+            if (variant < options_.accented_rate)
+                return accented_[rank];
+            variant -= options_.accented_rate;
+            if (variant < options_.hyphenated_rate)
+                return hyphenated_[rank];
+            return plain_[rank];
+        }
+
+        Options options_;
+        Detail::AliasTable ranks_;
+        std::uint64_t block_seed_;
+        Names plain_;
+        Names invalid_;
+        Names accented_;
+        Names hyphenated_;
+        std::size_t max_name_size_{ 0 };
+    };
+
+    enum class Format
+    {
+        Lines,   // One name per line
+        Csv,     // "surname,given_name" with a header row, for soundex_linkage
+        Columnar // Per block: u32 name count, u32 byte count, u32 end offsets, bytes
+    };
+
+    // Writes the first count names of generator's corpus to out, a batch of blocks per
+    // thread at a time. CSV rows pair each surname with a given name drawn from
+    // given_names, which may be the same generator. Returns the bytes written.
+    inline auto Write(const Generator& generator, const Generator& given_names, std::size_t count, Format format,
+                      std::ostream& out, std::size_t thread_count = 1) -> std::size_t
+    {
+        static constexpr std::string_view CSV_HEADER{ "surname,given_name\n" };
+        static constexpr std::size_t BLOCKS_PER_BATCH{ 16 };
+        const auto threads = Parallel::ThreadCount(thread_count);
+        const auto block_count = (count + Generator::BLOCK_SIZE - 1) / Generator::BLOCK_SIZE;
+        // Bytes a block can take, with the slack CopyName writes past the end
+        const auto row_size = generator.MaxNameSize() + given_names.MaxNameSize() + 2 * sizeof(std::uint32_t);
+        const auto block_size = Generator::BLOCK_SIZE * row_size + 2 * sizeof(std::uint32_t) + Generator::PADDING;
+        auto parts = std::vector<std::string>(threads);
+        auto bytes = std::size_t{ 0 };
+        if (format == Format::Csv)
+        {
+            out << CSV_HEADER;
+            bytes += std::size(CSV_HEADER);
+        }
+        for (std::size_t first = 0; first < block_count; first += threads * BLOCKS_PER_BATCH)
+        {
+            const auto batch = std::min(block_count - first, threads * BLOCKS_PER_BATCH);
+            Parallel::ForEachChunk(
+                batch, threads,
+                [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                {
+                    auto& part = parts[chunk];
+                    part.resize((end - begin) * block_size);
+                    auto* next = std::data(part);
+                    auto views = std::vector<std::string_view>{};
+                    for (auto block = first + begin; block < first + end; ++block)
+                    {
+                        if (format == Format::Lines)
+                        {
+                            generator.ForEachName(block, count,
+                                                  [&next](std::string_view name)
+                                                  {
+                                                      next = Detail::CopyName(next, name);
+                                                      *next++ = '\n';
+                                                  });
+                            continue;
+                        }
+                        views.clear();
+                        if (format == Format::Csv)
+                        {
+                            given_names.ForEachName(block, count,
+                                                    [&views](std::string_view name) { views.push_back(name); });
+                            auto i = std::size_t{ 0 };
+                            generator.ForEachName(block, count,
+                                                  [&](std::string_view name)
+                                                  {
+                                                      next = Detail::CopyName(next, name);
+                                                      *next++ = ',';
+                                                      next = Detail::CopyName(next, views[i++]);
+                                                      *next++ = '\n';
+                                                  });
+                            continue;
+                        }
+                        generator.ForEachName(block, count, [&views](std::string_view name) { views.push_back(name); });
+                        auto offset = std::uint32_t{ 0 };
+                        for (const auto name : views)
+                            offset += static_cast<std::uint32_t>(std::size(name));
+                        const auto header = std::array<std::uint32_t, 2>{ static_cast<std::uint32_t>(std::size(views)),
+                                                                          offset };
+                        std::memcpy(next, std::data(header), sizeof(header));
+                        next += sizeof(header);
+                        offset = 0;
+                        for (const auto name : views)
+                        {
+                            offset += static_cast<std::uint32_t>(std::size(name));
+                            std::memcpy(next, &offset, sizeof(offset));
+                            next += sizeof(offset);
+                        }
+                        for (const auto name : views)
+                            next = Detail::CopyName(next, name);
+                    }
+                    part.resize(static_cast<std::size_t>(next - std::data(part)));
+                });
+            for (std::size_t chunk = 0; chunk < std::min(threads, batch); ++chunk)
+            {
+                out.write(std::data(parts[chunk]), static_cast<std::streamsize>(std::size(parts[chunk])));
+                bytes += std::size(parts[chunk]);
+            }
+        }
+        return bytes;
+    }
+} // namespace Corpus
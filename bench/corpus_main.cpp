@@ -0,0 +1,119 @@
+//
+// Command line front end of Corpus::Write: generates a synthetic surname corpus.
+//
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "bench.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+    auto PrintUsage() -> void
+    {
+        std::cerr << "Usage: soundex_corpus --names N [options] > names.txt\n"
+                     "  --names N             names to generate\n"
+                     "  --seed N              random seed; the same seed gives the same corpus (default 1)\n"
+                     "  --format NAME         lines, csv or columnar (default lines)\n"
+                     "  --vocabulary N        distinct names drawn from (default 65536)\n"
+                     "  --zipf X              Zipf exponent of the name frequencies (default 1)\n"
+                     "  --invalid X           fraction of names that cannot be encoded (default 0)\n"
+                     "  --accented X          fraction of names with an accented letter (default 0)\n"
+                     "  --hyphenated X        fraction of double-barrelled names (default 0)\n"
+                     "  --threads N           worker threads, 0 for all (default 0)\n"
+                     "  --output FILE         write there instead of to standard output\n";
+    }
+
+    auto ParseFormat(std::string_view format) -> Corpus::Format
+    {
+        if (format == "lines")
+            return Corpus::Format::Lines;
+        if (format == "csv")
+            return Corpus::Format::Csv;
+        if (format == "columnar")
+            return Corpus::Format::Columnar;
+        throw std::invalid_argument("Unknown format " + std::string{ format });
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto options = Corpus::Options{};
+    auto count = std::size_t{ 0 };
+    auto format = Corpus::Format::Lines;
+    auto thread_count = std::size_t{ 0 };
+    auto output_path = std::string{};
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const auto argument = std::string_view{ argv[i] };
+            const auto value = [&]
+            {
+                if (i + 1 == argc)
+                    throw std::invalid_argument("Missing value for " + std::string{ argument });
+                return std::string{ argv[++i] };
+            };
+            if (argument == "--names")
+                count = std::stoull(value());
+            else if (argument == "--seed")
+                options.seed = std::stoull(value());
+            else if (argument == "--format")
+                format = ParseFormat(value());
+            else if (argument == "--vocabulary")
+                options.vocabulary = std::stoull(value());
+            else if (argument == "--zipf")
+                options.zipf_exponent = std::stod(value());
+            else if (argument == "--invalid")
+                options.invalid_rate = std::stod(value());
+            else if (argument == "--accented")
+                options.accented_rate = std::stod(value());
+            else if (argument == "--hyphenated")
+                options.hyphenated_rate = std::stod(value());
+            else if (argument == "--threads")
+                thread_count = std::stoul(value());
+            else if (argument == "--output")
+                output_path = value();
+            else
+                throw std::invalid_argument("Unknown option " + std::string{ argument });
+        }
+        if (count == 0)
+            throw std::invalid_argument("--names is required");
+
+        auto file = std::ofstream{};
+        if (!output_path.empty())
+        {
+            file.open(output_path, std::ios::binary);
+            if (!file)
+                throw std::runtime_error("Cannot open " + output_path);
+        }
+        auto& out = output_path.empty() ? std::cout : file;
+
+        const auto start = Bench::Clock::now();
+        const auto generator = Corpus::Generator{ options };
+        // Given names: a smaller vocabulary, plain, from another seed
+        auto given_options = Corpus::Options{};
+        given_options.seed = options.seed + 1;
+        given_options.vocabulary = 4096;
+        const auto given_names = Corpus::Generator{ given_options };
+        const auto setup = Bench::SecondsSince(start);
+
+        const auto write_start = Bench::Clock::now();
+        const auto bytes = Corpus::Write(generator, given_names, count, format, out, thread_count);
+        out.flush();
+        const auto seconds = Bench::SecondsSince(write_start);
+        std::cerr << count << " names in " << seconds << " s after " << setup << " s of setup, "
+                  << static_cast<double>(bytes) / seconds / 1e9 << " GB/s\n";
+        if (!out)
+            throw std::runtime_error("Cannot write the corpus");
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+}
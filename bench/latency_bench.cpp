@@ -0,0 +1,236 @@
+//
+// Latency of single calls: the legacy Soundex::Encode, Soundex::EncodeInto, the cached
+// encoder and lookups in the indexes, each call timed on its own with Bench::Ticks and
+// recorded in a histogram, written as JSON percentiles in nanoseconds.
+//
+// The first result is the very first Soundex::Encode of the process, which builds the
+// static table of Soundex::EncodeDigit, next to a second call of the same name. It has
+// to run before anything else encodes, which is why the indexes are built after it.
+//
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../code_index.hpp"
+#include "../daitch_mokotoff.hpp"
+#include "../phonetic_encoder.hpp"
+#include "../phonetic_index.hpp"
+#include "../soundex.hpp"
+#include "bench.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+    auto PrintUsage() -> void
+    {
+        std::cerr << "Usage: latency_bench [options] > results.json\n"
+                     "  --quick               fewer calls\n"
+                     "  --calls N             timed calls per operation (default 1000000)\n"
+                     "  --index-names N       names in the indexes queried (default 1048576)\n"
+                     "  --operation NAME      only the operations whose name contains NAME\n"
+                     "  --output FILE         write the JSON there instead of to standard output\n";
+    }
+
+    struct Options
+    {
+        std::size_t calls{ 1000000 };
+        std::size_t index_names{ std::size_t{ 1 } << 20 };
+        std::string operation_filter;
+    };
+
+    // Ticks between two reads of the counter with nothing in between, the least of
+    // many tries; every latency includes it
+    auto TimerOverhead() -> std::uint64_t
+    {
+        auto overhead = ~std::uint64_t{ 0 };
+        for (int i = 0; i < 10000; ++i)
+        {
+            const auto start = Bench::Ticks();
+            overhead = std::min(overhead, Bench::Ticks() - start);
+        }
+        return overhead;
+    }
+
+    // Ticks of one call of fn
+    template <typename Fn>
+    auto TimeCall(Fn&& fn) -> std::uint64_t
+    {
+        const auto start = Bench::Ticks();
+        fn();
+        return Bench::Ticks() - start;
+    }
+
+    // An operation handles the query it is given and returns a value to keep alive
+    struct Operation
+    {
+        const char* name;
+        std::function<std::uint64_t(std::size_t query)> call;
+    };
+
+    struct Queries
+    {
+        Corpus::Names names;
+        std::vector<std::string_view> views;
+        std::vector<std::string> strings; // For the legacy API, which takes std::string
+    };
+
+    auto Operations(const Queries& queries, const PhoneticIndex& phonetic_index,
+                    const CodeIndex<DaitchMokotoff>& code_index) -> std::vector<Operation>
+    {
+        auto operations = std::vector<Operation>{};
+        operations.push_back({ "soundex-encode",
+                               [&queries](std::size_t query)
+                               { return std::uint64_t{ std::size(Soundex::Encode(queries.strings[query])) }; } });
+        operations.push_back({ "soundex-encode-into",
+                               [&queries](std::size_t query)
+                               {
+                                   auto code = SoundexCode{};
+                                   Soundex::EncodeInto(queries.views[query], code);
+                                   return std::uint64_t{ code.Packed() };
+                               } });
+        operations.push_back({ "soundex-cached",
+                               [&queries](std::size_t query)
+                               {
+                                   auto code = SoundexCode{};
+                                   PhoneticEncoder::Cached<Soundex>::EncodeAll(queries.views[query], &code);
+                                   return std::uint64_t{ code.Packed() };
+                               } });
+        operations.push_back({ "phonetic-index-lookup",
+                               [&queries, &phonetic_index](std::size_t query)
+                               { return std::uint64_t{ phonetic_index.Lookup(queries.views[query]).size() }; } });
+        operations.push_back({ "code-index-lookup-daitch-mokotoff",
+                               [&queries, &code_index](std::size_t query)
+                               {
+                                   thread_local auto ids = std::vector<std::uint32_t>{};
+                                   code_index.LookupInto(queries.views[query], ids);
+                                   return std::uint64_t{ std::size(ids) };
+                               } });
+        return operations;
+    }
+
+    auto AddPercentiles(Bench::JsonWriter& json, const Bench::LatencyHistogram& histogram,
+                        double ticks_per_nanosecond) -> void
+    {
+        const auto nanoseconds = [&](std::uint64_t ticks) { return static_cast<double>(ticks) / ticks_per_nanosecond; };
+        json.Field("calls", histogram.Count())
+            .Field("min_ns", nanoseconds(histogram.Min()))
+            .Field("mean_ns", histogram.Mean() / ticks_per_nanosecond)
+            .Field("p50_ns", nanoseconds(histogram.Percentile(50)))
+            .Field("p90_ns", nanoseconds(histogram.Percentile(90)))
+            .Field("p99_ns", nanoseconds(histogram.Percentile(99)))
+            .Field("p99.9_ns", nanoseconds(histogram.Percentile(99.9)))
+            .Field("p99.99_ns", nanoseconds(histogram.Percentile(99.99)))
+            .Field("max_ns", nanoseconds(histogram.Max()));
+    }
+
+    auto Run(const Options& options, Bench::JsonWriter& json) -> void
+    {
+        // Zipfian like the names of a service, and all valid, so the legacy API does
+        // not throw
+        auto queries = Queries{};
+        queries.names = Corpus::Generator{ Corpus::Options{} }.Generate(options.calls);
+        queries.views = queries.names.Views();
+        for (const auto view : queries.views)
+            queries.strings.emplace_back(view);
+
+        const auto ticks_per_nanosecond = Bench::TicksPerNanosecond();
+        const auto overhead = TimerOverhead();
+
+        auto checksum = std::uint64_t{ 0 };
+        const auto first_call = TimeCall([&] { checksum += std::size(Soundex::Encode(queries.strings[0])); });
+        const auto second_call = TimeCall([&] { checksum += std::size(Soundex::Encode(queries.strings[0])); });
+        json.Result()
+            .Field("operation", "soundex-encode-first-call")
+            .Field("first_call_ns", static_cast<double>(first_call) / ticks_per_nanosecond)
+            .Field("second_call_ns", static_cast<double>(second_call) / ticks_per_nanosecond)
+            .Field("timer_overhead_ns", static_cast<double>(overhead) / ticks_per_nanosecond)
+            .Field("ticks_per_ns", ticks_per_nanosecond);
+        std::cerr << "soundex-encode first call: " << static_cast<double>(first_call) / ticks_per_nanosecond
+                  << " ns, second call: " << static_cast<double>(second_call) / ticks_per_nanosecond << " ns\n";
+
+        auto corpus = Corpus::Options{};
+        corpus.seed += 1000;
+        const auto names = Corpus::Generator{ corpus }.Generate(options.index_names);
+        const auto views = names.Views();
+        const auto phonetic_index = PhoneticIndex{ views, Parallel::ThreadCount(0) };
+        const auto code_index = CodeIndex<DaitchMokotoff>{ views, Parallel::ThreadCount(0) };
+
+        for (const auto& operation : Operations(queries, phonetic_index, code_index))
+        {
+            if (std::string_view{ operation.name }.find(options.operation_filter) == std::string_view::npos)
+                continue;
+            // One untimed pass warms the caches and the branch predictors
+            for (std::size_t query = 0; query < std::min<std::size_t>(std::size(queries.views), 10000); ++query)
+                checksum += operation.call(query);
+            auto histogram = Bench::LatencyHistogram{};
+            for (std::size_t query = 0; query < std::size(queries.views); ++query)
+                histogram.Record(TimeCall([&] { checksum += operation.call(query); }));
+            json.Result().Field("operation", operation.name);
+            AddPercentiles(json, histogram, ticks_per_nanosecond);
+            std::cerr << operation.name << ": p50 "
+                      << static_cast<double>(histogram.Percentile(50)) / ticks_per_nanosecond << " ns, p99.9 "
+                      << static_cast<double>(histogram.Percentile(99.9)) / ticks_per_nanosecond << " ns, max "
+                      << static_cast<double>(histogram.Max()) / ticks_per_nanosecond << " ns\n";
+        }
+        Bench::DoNotOptimize(checksum);
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto options = Options{};
+    auto output_path = std::string{};
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const auto argument = std::string_view{ argv[i] };
+            const auto value = [&]
+            {
+                if (i + 1 == argc)
+                    throw std::invalid_argument("Missing value for " + std::string{ argument });
+                return std::string{ argv[++i] };
+            };
+            if (argument == "--quick")
+            {
+                options.calls = 100000;
+                options.index_names = std::size_t{ 1 } << 16;
+            }
+            else if (argument == "--calls")
+                options.calls = std::stoul(value());
+            else if (argument == "--index-names")
+                options.index_names = std::stoul(value());
+            else if (argument == "--operation")
+                options.operation_filter = value();
+            else if (argument == "--output")
+                output_path = value();
+            else
+                throw std::invalid_argument("Unknown option " + std::string{ argument });
+        }
+        if (options.calls == 0 || options.index_names == 0)
+            throw std::invalid_argument("Calls and index names must not be empty");
+
+        auto file = std::ofstream{};
+        if (!output_path.empty())
+        {
+            file.open(output_path);
+            if (!file)
+                throw std::runtime_error("Cannot open " + output_path);
+        }
+        auto json = Bench::JsonWriter{ output_path.empty() ? std::cout : file, "latency_bench" };
+        Run(options, json);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,312 @@
+//
+// Thread scaling of the parallel paths: batch encoding, index building and batched
+// queries at 1, 2, 4, ... N threads, written as JSON.
+//
+// Each result gives the throughput, the speedup and parallel efficiency against one
+// thread, and the memory bandwidth the workload used next to what a parallel copy
+// reaches with the same threads. A workload that stops scaling while far from the
+// copy bandwidth is limited by something else than memory: serial phases, the merge
+// of per-thread results, or thread start-up on small inputs.
+//
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "../batch_encode.hpp"
+#include "../code_index.hpp"
+#include "../daitch_mokotoff.hpp"
+#include "../parallel.hpp"
+#include "../phonetic_index.hpp"
+#include "../soundex.hpp"
+#include "bench.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+    auto PrintUsage() -> void
+    {
+        std::cerr << "Usage: scaling_bench [options] > results.json\n"
+                     "  --quick               fewer names and repetitions\n"
+                     "  --names N             names encoded and indexed (default 4194304)\n"
+                     "  --max-threads N       most threads tried (default: hardware threads)\n"
+                     "  --repetitions N       timed runs per result, the median is kept (default 5)\n"
+                     "  --workload NAME       only the workloads whose name contains NAME\n"
+                     "  --output FILE         write the JSON there instead of to standard output\n";
+    }
+
+    struct Options
+    {
+        std::size_t names{ std::size_t{ 1 } << 22 };
+        std::size_t max_threads{ Parallel::ThreadCount(0) };
+        std::size_t repetitions{ 5 };
+        std::string workload_filter;
+    };
+
+    // 1, 2, 4, ... up to max_threads, which is always included
+    auto ThreadCounts(std::size_t max_threads) -> std::vector<std::size_t>
+    {
+        auto counts = std::vector<std::size_t>{};
+        for (std::size_t count = 1; count < max_threads; count *= 2)
+            counts.push_back(count);
+        counts.push_back(max_threads);
+        return counts;
+    }
+
+    // Bytes per second of a parallel copy between two buffers of size bytes, counting
+    // the bytes read and written
+    auto CopyBandwidth(std::size_t size, std::size_t threads, std::size_t repetitions) -> double
+    {
+        auto source = std::vector<char>(size, 'x');
+        auto destination = std::vector<char>(size);
+        const auto seconds = Bench::MedianSeconds(
+            repetitions,
+            [&]
+            {
+                Parallel::ForEachChunk(size, threads,
+                                       [&](std::size_t, std::size_t begin, std::size_t end) {
+                                           std::memcpy(std::data(destination) + begin, std::data(source) + begin,
+                                                       end - begin);
+                                       });
+            });
+        Bench::DoNotOptimize(destination.back());
+        return 2.0 * static_cast<double>(size) / seconds;
+    }
+
+    struct Data
+    {
+        Corpus::Names names;
+        std::vector<std::string_view> views;
+        // Drawn from the same vocabulary, so most queries have candidates
+        Corpus::Names queries;
+        std::vector<std::string_view> query_views;
+    };
+
+    // A workload runs with the given threads and returns an estimate of the bytes it
+    // read and wrote: its inputs, its outputs and the index memory it went through.
+    // Queries of frequent names go through the same index memory again and again, so
+    // their bandwidth can exceed the copy bandwidth: it is then served by the caches.
+    struct Workload
+    {
+        const char* name;
+        std::size_t items; // Names encoded or indexed, or queries
+        std::function<std::uint64_t(std::size_t threads)> run;
+    };
+
+    // Sum of fn(query, ids) over the queries, split among threads; ids is a vector
+    // reused by the queries of a thread
+    template <typename Fn>
+    auto SumOverQueries(const Data& data, std::size_t threads, Fn fn) -> std::uint64_t
+    {
+        auto sums = std::vector<std::uint64_t>(threads);
+        Parallel::ForEachChunk(std::size(data.query_views), threads,
+                               [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                               {
+                                   // Summed locally, so the threads do not share the cache
+                                   // lines of sums until the one store at the end
+                                   auto ids = std::vector<std::uint32_t>{};
+                                   auto sum = std::uint64_t{ 0 };
+                                   for (auto i = begin; i < end; ++i)
+                                       sum += fn(data.query_views[i], ids);
+                                   sums[chunk] = sum;
+                               });
+        auto total = std::uint64_t{ 0 };
+        for (const auto sum : sums)
+            total += sum;
+        return total;
+    }
+
+    auto Workloads(const Data& data, std::size_t max_threads) -> std::vector<Workload>
+    {
+        constexpr auto VIEW_SIZE = std::uint64_t{ sizeof(std::string_view) };
+        const auto names = std::uint64_t{ std::size(data.views) };
+        const auto queries = std::uint64_t{ std::size(data.query_views) };
+        const auto name_bytes = std::uint64_t{ std::size(data.names.buffer) } + names * VIEW_SIZE;
+        const auto query_bytes = std::uint64_t{ std::size(data.queries.buffer) } + queries * VIEW_SIZE;
+
+        // Built once for the queries, with every thread
+        const auto phonetic_index = std::make_shared<const PhoneticIndex>(data.views, max_threads);
+        const auto code_index = std::make_shared<const CodeIndex<DaitchMokotoff>>(data.views, max_threads);
+
+        auto workloads = std::vector<Workload>{};
+        workloads.push_back({ "batch-encode-soundex", std::size(data.views),
+                              [&data, name_bytes](std::size_t threads)
+                              {
+                                  thread_local auto columns = std::tuple<BatchEncode::Column<SoundexCode>>{};
+                                  BatchEncode::EncodeColumnsInto<Soundex>(data.views, columns, threads);
+                                  const auto& column = std::get<0>(columns);
+                                  return name_bytes + std::size(column.codes) * sizeof(SoundexCode) +
+                                         std::size(column.offsets) * sizeof(std::uint32_t);
+                              } });
+        workloads.push_back({ "batch-encode-daitch-mokotoff", std::size(data.views),
+                              [&data, name_bytes](std::size_t threads)
+                              {
+                                  thread_local auto columns = std::tuple<BatchEncode::Column<DaitchMokotoffCode>>{};
+                                  BatchEncode::EncodeColumnsInto<DaitchMokotoff>(data.views, columns, threads);
+                                  const auto& column = std::get<0>(columns);
+                                  return name_bytes + std::size(column.codes) * sizeof(DaitchMokotoffCode) +
+                                         std::size(column.offsets) * sizeof(std::uint32_t);
+                              } });
+        workloads.push_back({ "phonetic-index-build", std::size(data.views),
+                              [&data, name_bytes](std::size_t threads)
+                              {
+                                  const auto index = PhoneticIndex{ data.views, threads };
+                                  // The names are copied into the index buffer, with a view each
+                                  return 2 * name_bytes + index.Size() * sizeof(SoundexCode);
+                              } });
+        workloads.push_back(
+            { "code-index-build-daitch-mokotoff", std::size(data.views),
+              [&data, name_bytes](std::size_t threads)
+              {
+                  const auto index = CodeIndex<DaitchMokotoff>{ data.views, threads };
+                  return name_bytes + index.Size() * (sizeof(DaitchMokotoffCode) + sizeof(std::uint32_t));
+              } });
+        workloads.push_back({ "phonetic-index-queries", std::size(data.query_views),
+                              [&data, query_bytes, phonetic_index](std::size_t threads)
+                              {
+                                  const auto candidates = SumOverQueries(
+                                      data, threads,
+                                      [&](std::string_view query, std::vector<std::uint32_t>&)
+                                      {
+                                          // Reads the views, as a caller comparing the names would
+                                          auto count = std::uint64_t{ 0 };
+                                          for (const auto name : phonetic_index->Lookup(query))
+                                              count += std::size(name) != 0;
+                                          return count;
+                                      });
+                                  return query_bytes + candidates * VIEW_SIZE;
+                              } });
+        workloads.push_back({ "code-index-queries-daitch-mokotoff", std::size(data.query_views),
+                              [&data, query_bytes, code_index](std::size_t threads)
+                              {
+                                  const auto candidates = SumOverQueries(
+                                      data, threads,
+                                      [&](std::string_view query, std::vector<std::uint32_t>& ids)
+                                      {
+                                          code_index->LookupInto(query, ids);
+                                          return std::uint64_t{ std::size(ids) };
+                                      });
+                                  return query_bytes + candidates * sizeof(std::uint32_t);
+                              } });
+        return workloads;
+    }
+
+    auto Run(const Options& options, Bench::JsonWriter& json) -> void
+    {
+        auto data = Data{};
+        auto corpus = Corpus::Options{};
+        data.names = Corpus::Generator{ corpus }.Generate(options.names, options.max_threads);
+        data.views = data.names.Views();
+        corpus.seed += 1000;
+        data.queries = Corpus::Generator{ corpus }.Generate(options.names / 4, options.max_threads);
+        data.query_views = data.queries.Views();
+
+        const auto thread_counts = ThreadCounts(options.max_threads);
+        // Large enough to spill the last level cache, like the workloads
+        const auto copy_size = std::max<std::size_t>(std::size(data.names.buffer) * 4, std::size_t{ 1 } << 26);
+        auto copy_bandwidth = std::vector<double>{};
+        for (const auto threads : thread_counts)
+        {
+            copy_bandwidth.push_back(CopyBandwidth(copy_size, threads, options.repetitions));
+            std::cerr << "copy, " << threads << " threads: " << copy_bandwidth.back() / 1e9 << " GB/s\n";
+        }
+
+        for (const auto& workload : Workloads(data, options.max_threads))
+        {
+            if (std::string_view{ workload.name }.find(options.workload_filter) == std::string_view::npos)
+                continue;
+            const auto items = static_cast<double>(workload.items);
+            auto single_thread_seconds = 0.0;
+            for (std::size_t i = 0; i < std::size(thread_counts); ++i)
+            {
+                const auto threads = thread_counts[i];
+                auto bytes = std::uint64_t{ 0 };
+                const auto seconds =
+                    Bench::MedianSeconds(options.repetitions, [&] { bytes = workload.run(threads); });
+                if (threads == 1)
+                    single_thread_seconds = seconds;
+                const auto speedup = single_thread_seconds / seconds;
+                const auto bandwidth = static_cast<double>(bytes) / seconds;
+                json.Result()
+                    .Field("workload", workload.name)
+                    .Field("threads", std::uint64_t{ threads })
+                    .Field("items", std::uint64_t{ workload.items })
+                    .Field("seconds", seconds)
+                    .Field("items_per_second", items / seconds)
+                    .Field("speedup", speedup)
+                    .Field("parallel_efficiency", speedup / static_cast<double>(threads))
+                    .Field("bytes_per_second", bandwidth)
+                    .Field("copy_bytes_per_second", copy_bandwidth[i])
+                    .Field("bandwidth_utilisation", bandwidth / copy_bandwidth[i]);
+                std::cerr << workload.name << ", " << threads << " threads: " << items / seconds / 1e6
+                          << " M/s, efficiency " << speedup / static_cast<double>(threads) << ", "
+                          << bandwidth / copy_bandwidth[i] * 100 << "% of copy bandwidth\n";
+            }
+        }
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto options = Options{};
+    auto output_path = std::string{};
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const auto argument = std::string_view{ argv[i] };
+            const auto value = [&]
+            {
+                if (i + 1 == argc)
+                    throw std::invalid_argument("Missing value for " + std::string{ argument });
+                return std::string{ argv[++i] };
+            };
+            if (argument == "--quick")
+            {
+                options.names = std::size_t{ 1 } << 18;
+                options.repetitions = 3;
+            }
+            else if (argument == "--names")
+                options.names = std::stoul(value());
+            else if (argument == "--max-threads")
+                options.max_threads = std::stoul(value());
+            else if (argument == "--repetitions")
+                options.repetitions = std::stoul(value());
+            else if (argument == "--workload")
+                options.workload_filter = value();
+            else if (argument == "--output")
+                output_path = value();
+            else
+                throw std::invalid_argument("Unknown option " + std::string{ argument });
+        }
+        if (options.names < 4 || options.max_threads == 0 || options.repetitions == 0)
+            throw std::invalid_argument("Names, threads and repetitions must not be empty");
+
+        auto file = std::ofstream{};
+        if (!output_path.empty())
+        {
+            file.open(output_path);
+            if (!file)
+                throw std::runtime_error("Cannot open " + output_path);
+        }
+        auto json = Bench::JsonWriter{ output_path.empty() ? std::cout : file, "scaling_bench" };
+        Run(options, json);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,322 @@
+//
+// Throughput of the legacy Soundex::Encode and of every encoding kernel, in ns per
+// name and names per second, written as JSON.
+//
+// Each kernel runs over data sets that vary the name lengths, the fraction of names
+// that cannot be encoded, and whether the names fit in cache: hot sets hold 1024
+// names encoded again and again, cold sets are far larger than the last level cache.
+// Where perf_event_open allows, results also give cycles, instructions, branch misses
+// and cache misses per name, to tell branch, cache and frontend bound kernels apart.
+//
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "../batch_encode.hpp"
+#include "../daitch_mokotoff.hpp"
+#include "../double_metaphone.hpp"
+#include "../multi_key.hpp"
+#include "../nysiis.hpp"
+#include "../phonetic_encoder.hpp"
+#include "../refined_soundex.hpp"
+#include "../soundex.hpp"
+#include "bench.hpp"
+#include "corpus.hpp"
+
+namespace
+{
+    auto PrintUsage() -> void
+    {
+        std::cerr << "Usage: soundex_bench [options] > results.json\n"
+                     "  --quick               smaller data sets and fewer repetitions\n"
+                     "  --cold-names N        names in the cold data sets (default 4194304)\n"
+                     "  --repetitions N       timed runs per result, the median is kept (default 5)\n"
+                     "  --kernel NAME         only the kernels whose name contains NAME\n"
+                     "  --no-counters         do not read the hardware counters (perf_event_open)\n"
+                     "  --output FILE         write the JSON there instead of to standard output\n";
+    }
+
+    struct LengthProfile
+    {
+        const char* name;
+        // Weight of each name length, indexed by length
+        std::vector<double> weights;
+    };
+
+    struct DataSetSpec
+    {
+        LengthProfile lengths;
+        double invalid_rate;
+        bool hot;
+    };
+
+    // The names of a data set, stored back to back in one buffer
+    struct DataSet
+    {
+        std::string name;
+        Corpus::Names names;
+        std::vector<std::string_view> views;
+        std::vector<std::string> strings; // For the legacy API, which takes std::string
+        std::u16string buffer16;
+        std::vector<std::u16string_view> views16;
+        double mean_length{ 0.0 };
+    };
+
+    // Surnames from the synthetic corpus, with the lengths of the profile and a fraction
+    // of them made invalid by an apostrophe, a digit, a space or a period
+    auto MakeDataSet(const DataSetSpec& spec, std::size_t size, std::uint64_t seed) -> DataSet
+    {
+        auto options = Corpus::Options{};
+        options.seed = seed;
+        options.length_weights = spec.lengths.weights;
+        options.invalid_rate = spec.invalid_rate;
+
+        auto data = DataSet{};
+        data.name = std::string{ spec.lengths.name } + "/invalid-" +
+                    std::to_string(static_cast<int>(spec.invalid_rate * 100)) + "%/" + (spec.hot ? "hot" : "cold");
+        data.names = Corpus::Generator{ options }.Generate(size);
+        data.views = data.names.Views();
+        for (const auto view : data.views)
+            data.strings.emplace_back(view);
+        data.buffer16.assign(std::begin(data.names.buffer), std::end(data.names.buffer));
+        for (std::size_t i = 0; i < size; ++i)
+            data.views16.emplace_back(std::data(data.buffer16) + data.names.offsets[i],
+                                      data.names.offsets[i + 1] - data.names.offsets[i]);
+        data.mean_length = static_cast<double>(std::size(data.names.buffer)) / static_cast<double>(size);
+        return data;
+    }
+
+    // A kernel encodes every name of a data set and returns a checksum of the codes
+    struct Kernel
+    {
+        const char* name;
+        std::function<std::uint64_t(const DataSet&)> run;
+    };
+
+    template <typename Encoder>
+    auto EncodeAllKernel(const char* label) -> Kernel
+    {
+        return { label,
+                 [](const DataSet& data)
+                 {
+                     auto checksum = std::uint64_t{ 0 };
+                     auto codes = std::array<typename Encoder::Code, Encoder::MAX_CODES>{};
+                     for (const auto name : data.views)
+                     {
+                         const auto count = Encoder::EncodeAll(name, std::data(codes));
+                         checksum += count == 0 ? 0 : static_cast<std::uint64_t>(codes[0].Packed());
+                     }
+                     return checksum;
+                 } };
+    }
+
+    auto Kernels() -> std::vector<Kernel>
+    {
+        auto kernels = std::vector<Kernel>{};
+        kernels.push_back({ "soundex-legacy-encode",
+                            [](const DataSet& data)
+                            {
+                                auto checksum = std::uint64_t{ 0 };
+                                for (const auto& name : data.strings)
+                                {
+                                    try
+                                    {
+                                        checksum += static_cast<unsigned char>(Soundex::Encode(name).back());
+                                    }
+                                    catch (const std::runtime_error&)
+                                    {
+                                    }
+                                }
+                                return checksum;
+                            } });
+        kernels.push_back(EncodeAllKernel<Soundex>("soundex-encode-into"));
+        kernels.push_back({ "soundex-encode-into-utf16",
+                            [](const DataSet& data)
+                            {
+                                auto checksum = std::uint64_t{ 0 };
+                                auto code = SoundexCode{};
+                                for (const auto name : data.views16)
+                                    if (Soundex::EncodeInto(name, code))
+                                        checksum += code.Packed();
+                                return checksum;
+                            } });
+        kernels.push_back(EncodeAllKernel<BasicSoundex<8>>("soundex-8"));
+        kernels.push_back(EncodeAllKernel<BasicSoundex<4, SoundexRules::American>>("american-soundex"));
+        kernels.push_back(EncodeAllKernel<PhoneticEncoder::Cached<Soundex>>("soundex-cached"));
+        kernels.push_back(EncodeAllKernel<DaitchMokotoff>("daitch-mokotoff"));
+        kernels.push_back(EncodeAllKernel<DoubleMetaphone>("double-metaphone"));
+        kernels.push_back(EncodeAllKernel<Nysiis>("nysiis"));
+        kernels.push_back(EncodeAllKernel<RefinedSoundex>("refined-soundex"));
+        kernels.push_back({ "multi-key",
+                            [](const DataSet& data)
+                            {
+                                auto checksum = std::uint64_t{ 0 };
+                                auto keys = MultiKey::Keys<>{};
+                                for (const auto name : data.views)
+                                    if (MultiKey::EncodeInto(name, keys))
+                                        checksum +=
+                                            std::uint64_t{ keys.soundex.Packed() } + keys.metaphone.primary.Packed();
+                                return checksum;
+                            } });
+        kernels.push_back({ "batch-soundex",
+                            [](const DataSet& data)
+                            {
+                                thread_local auto columns = std::tuple<BatchEncode::Column<SoundexCode>>{};
+                                BatchEncode::EncodeColumnsInto<Soundex>(data.views, columns);
+                                return std::uint64_t{ std::get<0>(columns).rejected };
+                            } });
+        return kernels;
+    }
+
+    struct Options
+    {
+        std::size_t cold_names{ std::size_t{ 1 } << 22 };
+        std::size_t hot_names{ 1024 };
+        std::size_t repetitions{ 5 };
+        // Hot data sets are encoded this many times per timed run
+        std::size_t hot_passes{ 1000 };
+        std::string kernel_filter;
+        bool counters{ true };
+    };
+
+    // Fields of the hardware counts per name, and instructions per cycle, for the
+    // counters that could be read
+    auto AddCounterFields(Bench::JsonWriter& json, const Bench::Counters::Counts& counts, double names) -> void
+    {
+        for (std::size_t event = 0; event < Bench::Counters::EVENT_COUNT; ++event)
+            if (counts[event].has_value())
+                json.Field(std::string{ Bench::Counters::NAMES[event] } + "_per_name", *counts[event] / names);
+        const auto& cycles = counts[Bench::Counters::CYCLES];
+        const auto& instructions = counts[Bench::Counters::INSTRUCTIONS];
+        if (cycles.has_value() && instructions.has_value() && *cycles > 0)
+            json.Field("instructions_per_cycle", *instructions / *cycles);
+    }
+
+    auto Run(const Options& options, Bench::JsonWriter& json) -> void
+    {
+        const auto short_names = LengthProfile{ "short", { 0, 0, 1, 2, 3, 2 } };
+        const auto mixed_names = LengthProfile{ "mixed", Corpus::Options{}.length_weights };
+        auto long_names = LengthProfile{ "long", std::vector<double>(24, 1.0) };
+        std::fill_n(std::begin(long_names.weights), 12, 0.0);
+        auto specs = std::vector<DataSetSpec>{};
+        for (const auto hot : { true, false })
+        {
+            for (const auto& lengths : { short_names, mixed_names, long_names })
+                specs.push_back({ lengths, 0.0, hot });
+            for (const auto invalid_rate : { 0.1, 0.5 })
+                specs.push_back({ mixed_names, invalid_rate, hot });
+        }
+
+        auto counters = std::optional<Bench::Counters>{};
+        if (options.counters)
+        {
+            counters.emplace();
+            if (!counters->AnyAvailable())
+            {
+                std::cerr << "Hardware counters are not available, reporting times only\n";
+                counters.reset();
+            }
+        }
+
+        const auto kernels = Kernels();
+        auto seed = std::uint64_t{ 2022 };
+        for (const auto& spec : specs)
+        {
+            const auto data = MakeDataSet(spec, spec.hot ? options.hot_names : options.cold_names, seed++);
+            const auto passes = spec.hot ? options.hot_passes : 1;
+            for (const auto& kernel : kernels)
+            {
+                if (std::string_view{ kernel.name }.find(options.kernel_filter) == std::string_view::npos)
+                    continue;
+                auto checksum = std::uint64_t{ 0 };
+                const auto run = [&]
+                {
+                    for (std::size_t pass = 0; pass < passes; ++pass)
+                        checksum += kernel.run(data);
+                };
+                const auto seconds = Bench::MedianSeconds(options.repetitions, run);
+                // One more run, warm like the timed ones, for the counters
+                const auto counts = counters.has_value() ? counters->Measure(run) : Bench::Counters::Counts{};
+                Bench::DoNotOptimize(checksum);
+                const auto names = static_cast<double>(std::size(data.views) * passes);
+                json.Result()
+                    .Field("kernel", kernel.name)
+                    .Field("data_set", data.name)
+                    .Field("names", std::uint64_t{ std::size(data.views) })
+                    .Field("mean_length", data.mean_length)
+                    .Field("invalid_rate", spec.invalid_rate)
+                    .Field("cache_hot", spec.hot)
+                    .Field("ns_per_name", seconds * 1e9 / names)
+                    .Field("names_per_second", names / seconds);
+                AddCounterFields(json, counts, names);
+                std::cerr << kernel.name << ' ' << data.name << ": " << seconds * 1e9 / names << " ns/name\n";
+            }
+        }
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    auto options = Options{};
+    auto output_path = std::string{};
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const auto argument = std::string_view{ argv[i] };
+            const auto value = [&]
+            {
+                if (i + 1 == argc)
+                    throw std::invalid_argument("Missing value for " + std::string{ argument });
+                return std::string{ argv[++i] };
+            };
+            if (argument == "--quick")
+            {
+                options.cold_names = std::size_t{ 1 } << 18;
+                options.repetitions = 3;
+                options.hot_passes = 100;
+            }
+            else if (argument == "--cold-names")
+                options.cold_names = std::stoul(value());
+            else if (argument == "--repetitions")
+                options.repetitions = std::stoul(value());
+            else if (argument == "--no-counters")
+                options.counters = false;
+            else if (argument == "--kernel")
+                options.kernel_filter = value();
+            else if (argument == "--output")
+                output_path = value();
+            else
+                throw std::invalid_argument("Unknown option " + std::string{ argument });
+        }
+        if (options.cold_names == 0 || options.repetitions == 0)
+            throw std::invalid_argument("Data sets and repetitions must not be empty");
+
+        auto file = std::ofstream{};
+        if (!output_path.empty())
+        {
+            file.open(output_path);
+            if (!file)
+                throw std::runtime_error("Cannot open " + output_path);
+        }
+        auto json = Bench::JsonWriter{ output_path.empty() ? std::cout : file, "soundex_bench" };
+        Run(options, json);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,109 @@
+//
+// Index of names by phonetic code, for encoders that give a name several codes.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+#include "batch_encode.hpp"
+#include "phonetic_encoder.hpp"
+
+// Every (code, name) pair is an entry, and entries are sorted by code, so the names
+// of a code are a contiguous run found by binary search. Names that share any code
+// with a query are its candidates, as with Daitch–Mokotoff blocking.
+template <typename Encoder>
+class CodeIndex
+{
+    static_assert(PhoneticEncoder::IS_ENCODER<Encoder>, "Not a phonetic encoder");
+
+public:
+    using Code = typename Encoder::Code;
+
+    // Names that cannot be encoded are left out of the index
+    explicit CodeIndex(const std::vector<std::string_view>& names, std::size_t thread_count = 1)
+    {
+        const auto column = BatchEncode::EncodeColumn<Encoder>(names, thread_count);
+        rejected_ = column.rejected;
+        size_ = std::size(names) - rejected_;
+
+        auto order = std::vector<std::uint32_t>(std::size(column.codes));
+        std::iota(std::begin(order), std::end(order), std::uint32_t{ 0 });
+        // Ties keep input order, so the ids of a code come out sorted
+        std::stable_sort(std::begin(order), std::end(order),
+                         [&column](std::uint32_t lhs, std::uint32_t rhs)
+                         { return column.codes[lhs] < column.codes[rhs]; });
+
+        auto owners = std::vector<std::uint32_t>(std::size(column.codes));
+        for (std::size_t name = 0; name < column.Size(); ++name)
+            for (auto i = column.offsets[name]; i < column.offsets[name + 1]; ++i)
+                owners[i] = static_cast<std::uint32_t>(name);
+
+        codes_.reserve(std::size(order));
+        ids_.reserve(std::size(order));
+        for (const auto entry : order)
+        {
+            codes_.push_back(column.codes[entry]);
+            ids_.push_back(owners[entry]);
+        }
+    }
+
+    // Number of names indexed
+    auto Size() const -> std::size_t
+    {
+        return size_;
+    }
+
+    auto Rejected() const -> std::size_t
+    {
+        return rejected_;
+    }
+
+    // Positions in the input of the names with code, in input order
+    auto Ids(Code code) const -> std::vector<std::uint32_t>
+    {
+        const auto [first, last] = std::equal_range(std::begin(codes_), std::end(codes_), code);
+        return std::vector<std::uint32_t>(std::begin(ids_) + (first - std::begin(codes_)),
+                                          std::begin(ids_) + (last - std::begin(codes_)));
+    }
+
+    // Positions in the input of the names sharing a code with name, in input order;
+    // empty if name cannot be encoded
+    auto Lookup(std::string_view name) const -> std::vector<std::uint32_t>
+    {
+        auto ids = std::vector<std::uint32_t>{};
+        LookupInto(name, ids);
+        return ids;
+    }
+
+    // Same as Lookup, into ids, whose memory is reused: once it has grown to fit the
+    // candidates of the queries, lookups do not allocate
+    auto LookupInto(std::string_view name, std::vector<std::uint32_t>& ids) const -> void
+    {
+        ids.clear();
+        auto codes = std::array<Code, Encoder::MAX_CODES>{};
+        const auto count = Encoder::EncodeAll(name, std::data(codes));
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto [first, last] = std::equal_range(std::begin(codes_), std::end(codes_), codes[i]);
+            ids.insert(std::end(ids), std::begin(ids_) + (first - std::begin(codes_)),
+                       std::begin(ids_) + (last - std::begin(codes_)));
+        }
+        if (count > 1)
+        {
+            std::sort(std::begin(ids), std::end(ids));
+            ids.erase(std::unique(std::begin(ids), std::end(ids)), std::end(ids));
+        }
+    }
+
+private:
+    std::vector<Code> codes_;
+    std::vector<std::uint32_t> ids_;
+    std::size_t size_{ 0 };
+    std::size_t rejected_{ 0 };
+};
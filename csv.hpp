@@ -0,0 +1,86 @@
+//
+// Minimal RFC 4180 style CSV reading.
+//
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Csv
+{
+    // Reads rows one at a time. Fields may be quoted, with "" standing for a quote
+    // inside a quoted field, and quoted fields may span lines.
+    class Reader
+    {
+    public:
+        explicit Reader(std::istream& input) : input_{ input }
+        {
+        }
+
+        // Fills fields with the next row, reusing their storage. Returns false at the end of input.
+        auto ReadRow(std::vector<std::string>& fields) -> bool
+        {
+            if (!std::getline(input_, line_))
+                return false;
+            ++line_number_;
+            auto field_count = std::size_t{ 0 };
+            const auto next_field = [&]() -> std::string&
+            {
+                if (field_count == std::size(fields))
+                    fields.emplace_back();
+                auto& field = fields[field_count++];
+                field.clear();
+                return field;
+            };
+
+            auto* field = &next_field();
+            auto quoted = false;
+            for (auto i = std::size_t{ 0 };;)
+            {
+                if (i == std::size(line_))
+                {
+                    if (!quoted)
+                        break;
+                    // The quoted field goes on in the next line
+                    if (!std::getline(input_, line_))
+                        throw std::runtime_error("Unterminated quoted field on line " + std::to_string(line_number_));
+                    ++line_number_;
+                    field->push_back('\n');
+                    i = 0;
+                    continue;
+                }
+                const auto c = line_[i++];
+                if (quoted)
+                {
+                    if (c != '"')
+                        field->push_back(c);
+                    else if (i < std::size(line_) && line_[i] == '"')
+                        field->push_back(line_[i++]);
+                    else
+                        quoted = false;
+                }
+                else if (c == '"')
+                    quoted = true;
+                else if (c == ',')
+                    field = &next_field();
+                else if (c != '\r' || i != std::size(line_))
+                    field->push_back(c);
+            }
+            fields.resize(field_count);
+            return true;
+        }
+
+        auto LineNumber() const -> std::uint64_t
+        {
+            return line_number_;
+        }
+
+    private:
+        std::istream& input_;
+        std::string line_;
+        std::uint64_t line_number_{ 0 };
+    };
+} // namespace Csv
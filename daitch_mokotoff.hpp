@@ -0,0 +1,477 @@
+//
+// Daitch–Mokotoff Soundex, which suits Slavic, Germanic and Yiddish surnames better
+// than American Soundex.
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A six digit Daitch–Mokotoff code such as "097400", packed as its decimal value.
+// Comparing packed values orders codes exactly like comparing their strings.
+class DaitchMokotoffCode
+{
+public:
+    using Storage = std::uint32_t;
+
+    static constexpr std::size_t SIZE{ 6 };
+    static constexpr std::size_t BITS{ 20 };
+    static constexpr std::size_t RANK_COUNT{ 1000000 };
+
+    DaitchMokotoffCode() = default;
+
+    static auto FromPacked(Storage packed) -> DaitchMokotoffCode
+    {
+        return DaitchMokotoffCode{ packed };
+    }
+
+    static auto FromString(const std::string& code) -> DaitchMokotoffCode
+    {
+        if (std::size(code) != SIZE)
+            throw std::runtime_error("Not a Daitch-Mokotoff code: " + code);
+        auto packed = Storage{ 0 };
+        for (const auto digit : code)
+        {
+            if (digit < '0' || digit > '9')
+                throw std::runtime_error("Not a Daitch-Mokotoff code: " + code);
+            packed = packed * 10 + static_cast<Storage>(digit - '0');
+        }
+        return DaitchMokotoffCode{ packed };
+    }
+
+    auto Packed() const -> Storage
+    {
+        return packed_;
+    }
+
+    // Dense index in [0, RANK_COUNT), preserving code order
+    auto Rank() const -> std::size_t
+    {
+        return packed_;
+    }
+
+    static auto FromRank(std::size_t rank) -> DaitchMokotoffCode
+    {
+        return DaitchMokotoffCode{ static_cast<Storage>(rank) };
+    }
+
+    auto ToString() const -> std::string
+    {
+        auto code = std::string(SIZE, '0');
+        auto packed = packed_;
+        for (std::size_t i = SIZE; i-- > 0;)
+        {
+            code[i] = static_cast<char>('0' + packed % 10);
+            packed /= 10;
+        }
+        return code;
+    }
+
+    friend auto operator==(DaitchMokotoffCode lhs, DaitchMokotoffCode rhs) -> bool
+    {
+        return lhs.packed_ == rhs.packed_;
+    }
+
+    friend auto operator!=(DaitchMokotoffCode lhs, DaitchMokotoffCode rhs) -> bool
+    {
+        return lhs.packed_ != rhs.packed_;
+    }
+
+    friend auto operator<(DaitchMokotoffCode lhs, DaitchMokotoffCode rhs) -> bool
+    {
+        return lhs.packed_ < rhs.packed_;
+    }
+
+private:
+    explicit DaitchMokotoffCode(Storage packed) : packed_{ packed }
+    {
+    }
+
+    Storage packed_{ 0 };
+};
+
+// The Daitch–Mokotoff rule table and the letter trie it is compiled into
+namespace DaitchMokotoffRules
+{
+    // Up to two digits appended for one letter group
+    struct Digits
+    {
+        std::uint8_t size{ 0 };
+        std::array<std::uint8_t, 2> values{};
+
+        // Whether other is a suffix of this
+        constexpr auto EndsWith(const Digits& other) const -> bool
+        {
+            if (other.size > size)
+                return false;
+            for (std::size_t i = 0; i < other.size; ++i)
+                if (values[size - other.size + i] != other.values[i])
+                    return false;
+            return true;
+        }
+    };
+
+    // The alternative codings of a letter group in one position
+    struct Replacements
+    {
+        std::uint8_t count{ 0 };
+        std::array<Digits, 2> alternatives{};
+    };
+
+    struct Rule
+    {
+        Replacements at_start;
+        Replacements before_vowel;
+        Replacements other;
+    };
+
+    // Spelling of a rule: letter groups separated by spaces, then the codings at the
+    // start, before a vowel and elsewhere, with alternatives separated by '|' and an
+    // empty coding for letters that are not coded
+    struct RuleText
+    {
+        std::string_view groups;
+        std::string_view at_start;
+        std::string_view before_vowel;
+        std::string_view other;
+    };
+
+    inline constexpr std::array<RuleText, 58> RULE_TEXTS{ {
+        // Vowels
+        { "a", "0", "", "" },
+        { "ai aj ay", "0", "1", "" },
+        { "au", "0", "7", "" },
+        { "e", "0", "", "" },
+        { "ei ej ey", "0", "1", "" },
+        { "eu", "1", "1", "" },
+        { "i", "0", "", "" },
+        { "ia ie io iu", "1", "", "" },
+        { "o", "0", "", "" },
+        { "oi oj oy", "0", "1", "" },
+        { "u", "0", "", "" },
+        { "ue", "0", "", "" },
+        { "ui uj uy", "0", "1", "" },
+        { "y", "1", "", "" },
+        // Consonants
+        { "b", "7", "7", "7" },
+        { "c ch", "5|4", "5|4", "5|4" },
+        { "chs", "5", "54", "54" },
+        { "ck", "5|45", "5|45", "5|45" },
+        { "cz cs csz czs", "4", "4", "4" },
+        { "d dt", "3", "3", "3" },
+        { "drz drs ds dsh dsz dz dzh dzs", "4", "4", "4" },
+        { "f fb", "7", "7", "7" },
+        { "g", "5", "5", "5" },
+        { "h", "5", "5", "" },
+        { "j", "1|4", "|4", "|4" },
+        { "k kh", "5", "5", "5" },
+        { "ks", "5", "54", "54" },
+        { "l", "8", "8", "8" },
+        { "m", "6", "6", "6" },
+        { "mn nm", "66", "66", "66" },
+        { "n", "6", "6", "6" },
+        { "p pf ph", "7", "7", "7" },
+        { "q", "5", "5", "5" },
+        { "r", "9", "9", "9" },
+        { "rz rs", "94|4", "94|4", "94|4" },
+        { "s", "4", "4", "4" },
+        { "sc", "2", "4", "4" },
+        { "sch", "4", "4", "4" },
+        { "schtsch schtsh schtch", "2", "4", "4" },
+        { "sh", "4", "4", "4" },
+        { "shtch shch shtsh", "2", "4", "4" },
+        { "sht scht schd", "2", "43", "43" },
+        { "st", "2", "43", "43" },
+        { "stch stsch strz strs stsh", "2", "4", "4" },
+        { "sz", "4", "4", "4" },
+        { "szcz szcs", "2", "4", "4" },
+        { "szt shd szd sd", "2", "43", "43" },
+        { "t", "3", "3", "3" },
+        { "tch ttch ttsch tsch tsh", "4", "4", "4" },
+        { "th", "3", "3", "3" },
+        { "trz trs", "4", "4", "4" },
+        { "ts tts ttsz tc tz ttz tzs tsz", "4", "4", "4" },
+        { "v w", "7", "7", "7" },
+        { "x", "5", "54", "54" },
+        { "z", "4", "4", "4" },
+        { "zd zhd", "2", "43", "43" },
+        { "zdz zdzh zhdzh", "2", "4", "4" },
+        { "zh zs zsch zsh", "4", "4", "4" },
+    } };
+
+    inline constexpr std::size_t RULE_COUNT{ std::size(RULE_TEXTS) };
+
+    constexpr auto ParseReplacements(std::string_view text) -> Replacements
+    {
+        auto replacements = Replacements{};
+        auto* digits = &replacements.alternatives[0];
+        replacements.count = 1;
+        for (const auto c : text)
+        {
+            if (c == '|')
+                digits = &replacements.alternatives[replacements.count++];
+            else
+                digits->values[digits->size++] = static_cast<std::uint8_t>(c - '0');
+        }
+        return replacements;
+    }
+
+    constexpr auto ParseRule(const RuleText& text) -> Rule
+    {
+        return Rule{ ParseReplacements(text.at_start), ParseReplacements(text.before_vowel),
+                     ParseReplacements(text.other) };
+    }
+
+    constexpr auto MakeRules() -> std::array<Rule, RULE_COUNT>
+    {
+        auto rules = std::array<Rule, RULE_COUNT>{};
+        for (std::size_t i = 0; i < std::size(RULE_TEXTS); ++i)
+            rules[i] = ParseRule(RULE_TEXTS[i]);
+        return rules;
+    }
+
+    inline constexpr std::array<Rule, RULE_COUNT> RULES{ MakeRules() };
+
+    // Trie over the letter groups; node 0 is the root
+    inline constexpr std::size_t MAX_NODES{ 320 };
+    inline constexpr std::uint8_t NO_RULE{ 0xFF };
+
+    struct Node
+    {
+        std::array<std::uint16_t, 26> children{}; // 0 if absent
+        std::uint8_t rule{ NO_RULE };
+    };
+
+    using Trie = std::array<Node, MAX_NODES>;
+
+    constexpr auto LetterIndex(char letter) -> int
+    {
+        const auto lower = static_cast<char>(letter | 0x20);
+        return lower >= 'a' && lower <= 'z' ? lower - 'a' : -1;
+    }
+
+    constexpr auto AddGroups(Trie& trie, std::size_t& node_count, std::string_view groups, std::size_t rule)
+        -> void
+    {
+        auto node = std::size_t{ 0 };
+        for (const auto c : groups)
+        {
+            if (c == ' ')
+            {
+                trie[node].rule = static_cast<std::uint8_t>(rule);
+                node = 0;
+                continue;
+            }
+            auto& child = trie[node].children[static_cast<std::size_t>(LetterIndex(c))];
+            if (child == 0)
+            {
+                if (node_count == MAX_NODES)
+                    throw std::length_error("Daitch-Mokotoff trie is full");
+                child = static_cast<std::uint16_t>(node_count++);
+            }
+            node = child;
+        }
+        trie[node].rule = static_cast<std::uint8_t>(rule);
+    }
+
+    constexpr auto MakeTrie() -> Trie
+    {
+        auto trie = Trie{};
+        auto node_count = std::size_t{ 1 };
+        for (std::size_t i = 0; i < std::size(RULE_TEXTS); ++i)
+            AddGroups(trie, node_count, RULE_TEXTS[i].groups, i);
+        return trie;
+    }
+
+    inline constexpr Trie TRIE{ MakeTrie() };
+
+    struct Match
+    {
+        std::size_t rule;
+        std::size_t size;
+    };
+
+    // Longest letter group at position of word. Every letter is a group of its own,
+    // so there always is one.
+    inline auto LongestMatch(std::string_view word, std::size_t position) -> Match
+    {
+        auto match = Match{ NO_RULE, 0 };
+        auto node = std::size_t{ 0 };
+        for (auto i = position; i < std::size(word); ++i)
+        {
+            node = TRIE[node].children[static_cast<std::size_t>(LetterIndex(word[i]))];
+            if (node == 0)
+                break;
+            if (TRIE[node].rule != NO_RULE)
+                match = Match{ TRIE[node].rule, i - position + 1 };
+        }
+        return match;
+    }
+} // namespace DaitchMokotoffRules
+
+// Letter groups are coded differently at the start of a name, before a vowel and
+// elsewhere, and some of them have two codings ("ch" is 5 or 4), so a name can have
+// several codes: one per combination of alternatives.
+//
+// The rules are compiled into a letter trie at compile time. Encoding walks it for
+// the longest group at each position and carries every alternative along in fixed
+// arrays, so it does not allocate.
+class DaitchMokotoff
+{
+public:
+    using Code = DaitchMokotoffCode;
+
+    // Most codes a name can have. Real names stay far below it; beyond it the
+    // extra alternatives are dropped.
+    static constexpr std::size_t MAX_CODES{ 32 };
+
+    // Writes the distinct codes of word to codes and returns how many there are,
+    // 0 if word is not allowed (empty or not only ASCII letters)
+    static auto EncodeAll(std::string_view word, Code* codes) -> std::size_t
+    {
+        if (word.empty())
+            return 0;
+        for (const auto letter : word)
+            if (DaitchMokotoffRules::LetterIndex(letter) < 0)
+                return 0;
+
+        auto branches = std::array<Branch, 2 * MAX_CODES>{};
+        auto next_branches = std::array<Branch, 2 * MAX_CODES>{};
+        auto branch_count = std::size_t{ 1 };
+        auto previous_letter = '\0';
+        for (std::size_t i = 0; i < std::size(word);)
+        {
+            const auto [rule, size] = DaitchMokotoffRules::LongestMatch(word, i);
+            const auto letter = static_cast<char>(word[i] | 0x20);
+            const auto& replacements = Select(DaitchMokotoffRules::RULES[rule], word, i, size);
+            // "mn" and "nm" met across two groups are both coded
+            const auto force = (previous_letter == 'm' && letter == 'n') || (previous_letter == 'n' && letter == 'm');
+
+            if (replacements.count == 1)
+            {
+                for (std::size_t b = 0; b < branch_count; ++b)
+                    branches[b].Add(replacements.alternatives[0], force);
+            }
+            else
+            {
+                auto next_count = std::size_t{ 0 };
+                for (std::size_t b = 0; b < branch_count; ++b)
+                {
+                    for (std::size_t a = 0; a < replacements.count; ++a)
+                    {
+                        auto branch = branches[b];
+                        branch.Add(replacements.alternatives[a], force);
+                        auto duplicate = false;
+                        for (std::size_t other = 0; other < next_count && !duplicate; ++other)
+                            duplicate = next_branches[other] == branch;
+                        if (!duplicate && next_count < MAX_CODES)
+                            next_branches[next_count++] = branch;
+                    }
+                }
+                std::swap(branches, next_branches);
+                branch_count = next_count;
+            }
+            previous_letter = letter;
+            i += size;
+        }
+
+        auto code_count = std::size_t{ 0 };
+        for (std::size_t b = 0; b < branch_count; ++b)
+        {
+            const auto code = Code::FromPacked(branches[b].Padded());
+            auto duplicate = false;
+            for (std::size_t other = 0; other < code_count && !duplicate; ++other)
+                duplicate = codes[other] == code;
+            if (!duplicate)
+                codes[code_count++] = code;
+        }
+        return code_count;
+    }
+
+    // All codes of word as strings. Throws if word is not allowed.
+    static auto Encode(const std::string& word) -> std::vector<std::string>
+    {
+        auto codes = std::array<Code, MAX_CODES>{};
+        const auto count = EncodeAll(word, std::data(codes));
+        if (count == 0)
+            throw std::runtime_error("Invalid input: " + word);
+        auto encodings = std::vector<std::string>{};
+        for (std::size_t i = 0; i < count; ++i)
+            encodings.push_back(codes[i].ToString());
+        return encodings;
+    }
+
+private:
+    using Digits = DaitchMokotoffRules::Digits;
+    using Replacements = DaitchMokotoffRules::Replacements;
+    using Rule = DaitchMokotoffRules::Rule;
+
+    static auto IsVowel(char letter) -> bool
+    {
+        switch (letter | 0x20)
+        {
+        case 'a':
+        case 'e':
+        case 'i':
+        case 'o':
+        case 'u':
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static auto Select(const Rule& rule, std::string_view word, std::size_t position, std::size_t size)
+        -> const Replacements&
+    {
+        if (position == 0)
+            return rule.at_start;
+        const auto next = position + size;
+        if (next < std::size(word) && IsVowel(word[next]))
+            return rule.before_vowel;
+        return rule.other;
+    }
+
+    // One code being built
+    struct Branch
+    {
+        std::uint32_t value{ 0 };
+        std::uint8_t size{ 0 };
+        bool has_last{ false };
+        Digits last{};
+
+        // A coding is skipped when the previous one ends with it, unless forced
+        auto Add(const Digits& digits, bool force) -> void
+        {
+            if (!has_last || !last.EndsWith(digits) || force)
+            {
+                for (std::size_t i = 0; i < digits.size && size < DaitchMokotoffCode::SIZE; ++i)
+                {
+                    value = value * 10 + digits.values[i];
+                    ++size;
+                }
+            }
+            last = digits;
+            has_last = true;
+        }
+
+        auto Padded() const -> std::uint32_t
+        {
+            auto padded = value;
+            for (auto i = size; i < DaitchMokotoffCode::SIZE; ++i)
+                padded *= 10;
+            return padded;
+        }
+
+        friend auto operator==(const Branch& lhs, const Branch& rhs) -> bool
+        {
+            return lhs.value == rhs.value && lhs.size == rhs.size && lhs.has_last == rhs.has_last &&
+                   lhs.last.size == rhs.last.size && lhs.last.values == rhs.last.values;
+        }
+    };
+};
@@ -0,0 +1,726 @@
+//
+// Double Metaphone, which codes a name by its pronunciation, with an alternate code
+// for names that have a second, often foreign, pronunciation.
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "packed_code.hpp"
+
+struct DoubleMetaphoneAlphabet
+{
+    // Sounds in ASCII order, '0' (the "th" sound) first
+    static constexpr std::string_view SYMBOLS{ "0AFHJKLMNPRSTX" };
+};
+
+// A Double Metaphone code of up to four sounds, such as "XMT" or "AKSN", 4 bits each
+using DoubleMetaphoneCode = BasicPackedCode<DoubleMetaphoneAlphabet, 4>;
+
+// Lawrence Philips' Double Metaphone, following the Apache Commons Codec
+// implementation, with codes of four sounds.
+//
+// Letters that always give the same sound, such as 'B' or 'N', are coded from a
+// table; the others go through their context rules. Both codes are built in place
+// in their packed form, so encoding does not allocate. Input is ASCII letters
+// only, so the rules for names with spaces ("San Jacinto", "Van Damme") and for
+// 'Ç' and 'Ñ' never apply and are left out.
+class DoubleMetaphone
+{
+public:
+    using Code = DoubleMetaphoneCode;
+
+    struct Codes
+    {
+        Code primary;
+        Code alternate;
+    };
+
+    // Primary and, when it differs, alternate code, for BatchEncode and CodeIndex
+    static constexpr std::size_t MAX_CODES{ 2 };
+
+    // Returns false, leaving codes untouched, if word is not allowed (empty or not
+    // only ASCII letters)
+    static auto EncodeInto(std::string_view word, Codes& codes) -> bool
+    {
+        if (word.empty())
+            return false;
+        for (const auto letter : word)
+            if (SIMPLE_SOUNDS[static_cast<unsigned char>(letter)] == NOT_A_LETTER)
+                return false;
+
+        EncodeLetters(word, codes);
+        return true;
+    }
+
+    // EncodeInto without the input check, for callers that already made sure word
+    // is non-empty and only ASCII letters
+    static auto EncodeLetters(std::string_view word, Codes& codes) -> void
+    {
+        auto encoder = Encoder{ word };
+        encoder.Run();
+        codes = encoder.codes;
+    }
+
+    static auto EncodeAll(std::string_view word, Code* codes) -> std::size_t
+    {
+        auto both = Codes{};
+        if (!EncodeInto(word, both))
+            return 0;
+        codes[0] = both.primary;
+        if (both.alternate == both.primary)
+            return 1;
+        codes[1] = both.alternate;
+        return 2;
+    }
+
+    // Primary and alternate codes as strings. Throws if word is not allowed.
+    static auto Encode(const std::string& word) -> std::pair<std::string, std::string>
+    {
+        auto codes = Codes{};
+        if (!EncodeInto(word, codes))
+            throw std::runtime_error("Invalid input: " + word);
+        return { codes.primary.ToString(), codes.alternate.ToString() };
+    }
+
+private:
+    static constexpr char NOT_A_LETTER{ '\xFF' };
+    static constexpr char CONTEXTUAL{ '\0' };
+
+    // Sound of the letters coded without context, which are skipped when doubled;
+    // CONTEXTUAL for the others
+    static constexpr std::array<char, 256> SIMPLE_SOUNDS = []
+    {
+        auto sounds = std::array<char, 256>{};
+        for (auto& sound : sounds)
+            sound = NOT_A_LETTER;
+        for (auto letter = 'A'; letter <= 'Z'; ++letter)
+        {
+            sounds[static_cast<unsigned char>(letter)] = CONTEXTUAL;
+            sounds[static_cast<unsigned char>(letter - 'A' + 'a')] = CONTEXTUAL;
+        }
+        constexpr auto simple = std::string_view{ "BPFFKKNNQKVF" };
+        for (std::size_t i = 0; i < std::size(simple); i += 2)
+        {
+            sounds[static_cast<unsigned char>(simple[i])] = simple[i + 1];
+            sounds[static_cast<unsigned char>(simple[i] - 'A' + 'a')] = simple[i + 1];
+        }
+        return sounds;
+    }();
+
+    using Patterns = std::initializer_list<std::string_view>;
+
+    // State of one encoding: the word, read uppercase, and both codes so far
+    struct Encoder
+    {
+        std::string_view word;
+        Codes codes{};
+        bool slavo_germanic{ false };
+
+        explicit Encoder(std::string_view input) : word{ input }
+        {
+            slavo_germanic = Find("W") || Find("K") || Find("CZ") || Find("WITZ");
+        }
+
+        auto Size() const -> std::ptrdiff_t
+        {
+            return static_cast<std::ptrdiff_t>(std::size(word));
+        }
+
+        // Uppercase letter at index, '\0' outside the word
+        auto At(std::ptrdiff_t index) const -> char
+        {
+            if (index < 0 || index >= Size())
+                return '\0';
+            return static_cast<char>(word[static_cast<std::size_t>(index)] & 0xDF);
+        }
+
+        // Whether one of patterns, all of the same size, starts at start
+        auto Is(std::ptrdiff_t start, Patterns patterns) const -> bool
+        {
+            const auto size = static_cast<std::ptrdiff_t>(std::size(*std::begin(patterns)));
+            if (start < 0 || start + size > Size())
+                return false;
+            for (const auto pattern : patterns)
+            {
+                auto equal = true;
+                for (std::ptrdiff_t i = 0; i < size && equal; ++i)
+                    equal = At(start + i) == pattern[static_cast<std::size_t>(i)];
+                if (equal)
+                    return true;
+            }
+            return false;
+        }
+
+        auto Find(std::string_view pattern) const -> bool
+        {
+            for (std::ptrdiff_t start = 0; start < Size(); ++start)
+                if (Is(start, { pattern }))
+                    return true;
+            return false;
+        }
+
+        static auto IsVowel(char letter) -> bool
+        {
+            return letter == 'A' || letter == 'E' || letter == 'I' || letter == 'O' || letter == 'U' ||
+                   letter == 'Y';
+        }
+
+        auto Complete() const -> bool
+        {
+            return codes.primary.Size() == Code::SIZE && codes.alternate.Size() == Code::SIZE;
+        }
+
+        auto AddPrimary(std::string_view sounds) -> void
+        {
+            for (const auto sound : sounds)
+                codes.primary.Append(sound);
+        }
+
+        auto AddAlternate(std::string_view sounds) -> void
+        {
+            for (const auto sound : sounds)
+                codes.alternate.Append(sound);
+        }
+
+        auto Add(std::string_view sounds) -> void
+        {
+            AddPrimary(sounds);
+            AddAlternate(sounds);
+        }
+
+        auto Add(std::string_view primary, std::string_view alternate) -> void
+        {
+            AddPrimary(primary);
+            AddAlternate(alternate);
+        }
+
+        auto Run() -> void
+        {
+            auto index = std::ptrdiff_t{ Is(0, { "GN", "KN", "PN", "WR", "PS" }) ? 1 : 0 };
+            while (!Complete() && index < Size())
+            {
+                const auto letter = At(index);
+                const auto simple = SIMPLE_SOUNDS[static_cast<unsigned char>(letter)];
+                if (simple != CONTEXTUAL)
+                {
+                    Add(std::string_view{ &simple, 1 });
+                    index += At(index + 1) == letter ? 2 : 1;
+                    continue;
+                }
+                switch (letter)
+                {
+                case 'A':
+                case 'E':
+                case 'I':
+                case 'O':
+                case 'U':
+                case 'Y':
+                    if (index == 0)
+                        Add("A");
+                    ++index;
+                    break;
+                case 'C':
+                    index = HandleC(index);
+                    break;
+                case 'D':
+                    index = HandleD(index);
+                    break;
+                case 'G':
+                    index = HandleG(index);
+                    break;
+                case 'H':
+                    index = HandleH(index);
+                    break;
+                case 'J':
+                    index = HandleJ(index);
+                    break;
+                case 'L':
+                    index = HandleL(index);
+                    break;
+                case 'M':
+                    Add("M");
+                    index += ConditionM0(index) ? 2 : 1;
+                    break;
+                case 'P':
+                    index = HandleP(index);
+                    break;
+                case 'R':
+                    index = HandleR(index);
+                    break;
+                case 'S':
+                    index = HandleS(index);
+                    break;
+                case 'T':
+                    index = HandleT(index);
+                    break;
+                case 'W':
+                    index = HandleW(index);
+                    break;
+                case 'X':
+                    index = HandleX(index);
+                    break;
+                case 'Z':
+                    index = HandleZ(index);
+                    break;
+                default:
+                    ++index;
+                    break;
+                }
+            }
+        }
+
+        auto HandleC(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (ConditionC0(index))
+            {
+                Add("K");
+                return index + 2;
+            }
+            if (index == 0 && Is(index, { "CAESAR" }))
+            {
+                Add("S");
+                return index + 2;
+            }
+            if (Is(index, { "CH" }))
+                return HandleCH(index);
+            if (Is(index, { "CZ" }) && !Is(index - 2, { "WICZ" }))
+            {
+                // "Czerny"
+                Add("S", "X");
+                return index + 2;
+            }
+            if (Is(index + 1, { "CIA" }))
+            {
+                // "focaccia"
+                Add("X");
+                return index + 3;
+            }
+            if (Is(index, { "CC" }) && !(index == 1 && At(0) == 'M'))
+                return HandleCC(index);
+            if (Is(index, { "CK", "CG", "CQ" }))
+            {
+                Add("K");
+                return index + 2;
+            }
+            if (Is(index, { "CI", "CE", "CY" }))
+            {
+                // Italian or English
+                if (Is(index, { "CIO", "CIE", "CIA" }))
+                    Add("S", "X");
+                else
+                    Add("S");
+                return index + 2;
+            }
+            Add("K");
+            if (Is(index + 1, { "C", "K", "Q" }) && !Is(index + 1, { "CE", "CI" }))
+                return index + 2;
+            return index + 1;
+        }
+
+        auto HandleCC(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (Is(index + 2, { "I", "E", "H" }) && !Is(index + 2, { "HU" }))
+            {
+                // "bellocchio" but not "bacchus"
+                if ((index == 1 && At(index - 1) == 'A') || Is(index - 1, { "UCCEE", "UCCES" }))
+                    Add("KS"); // "accident", "accede", "succeed"
+                else
+                    Add("X"); // "bacci", "bertucci"
+                return index + 3;
+            }
+            Add("K");
+            return index + 2;
+        }
+
+        auto HandleCH(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (index > 0 && Is(index, { "CHAE" }))
+            {
+                // "Michael"
+                Add("K", "X");
+                return index + 2;
+            }
+            if (ConditionCH0(index) || ConditionCH1(index))
+            {
+                // Greek or Germanic roots: "chemistry", "chorus", "Bach"
+                Add("K");
+                return index + 2;
+            }
+            if (index > 0)
+            {
+                if (Is(0, { "MC" }))
+                    Add("K");
+                else
+                    Add("X", "K");
+            }
+            else
+            {
+                Add("X");
+            }
+            return index + 2;
+        }
+
+        auto HandleD(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (Is(index, { "DG" }))
+            {
+                if (Is(index + 2, { "I", "E", "Y" }))
+                {
+                    // "edge"
+                    Add("J");
+                    return index + 3;
+                }
+                // "Edgar"
+                Add("TK");
+                return index + 2;
+            }
+            Add("T");
+            return Is(index, { "DT", "DD" }) ? index + 2 : index + 1;
+        }
+
+        auto HandleG(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (At(index + 1) == 'H')
+                return HandleGH(index);
+            if (At(index + 1) == 'N')
+            {
+                if (index == 1 && IsVowel(At(0)) && !slavo_germanic)
+                    Add("KN", "N");
+                else if (!Is(index + 2, { "EY" }) && At(index + 1) != 'Y' && !slavo_germanic)
+                    Add("N", "KN");
+                else
+                    Add("KN");
+                return index + 2;
+            }
+            if (Is(index + 1, { "LI" }) && !slavo_germanic)
+            {
+                Add("KL", "L");
+                return index + 2;
+            }
+            if (index == 0 &&
+                (At(index + 1) == 'Y' || Is(index + 1, { "ES", "EP", "EB", "EL", "EY", "IB", "IL", "IN", "IE",
+                                                         "EI", "ER" })))
+            {
+                // -ges-, -gep-, -gel-, -gie- at the beginning
+                Add("K", "J");
+                return index + 2;
+            }
+            if ((Is(index + 1, { "ER" }) || At(index + 1) == 'Y') &&
+                !Is(0, { "DANGER", "RANGER", "MANGER" }) && !Is(index - 1, { "E", "I" }) &&
+                !Is(index - 1, { "RGY", "OGY" }))
+            {
+                // -ger-, -gy-
+                Add("K", "J");
+                return index + 2;
+            }
+            if (Is(index + 1, { "E", "I", "Y" }) || Is(index - 1, { "AGGI", "OGGI" }))
+            {
+                // Italian "biaggi"
+                if (Is(0, { "SCH" }) || Is(index + 1, { "ET" }))
+                    Add("K"); // Germanic
+                else if (Is(index + 1, { "IER" }))
+                    Add("J");
+                else
+                    Add("J", "K");
+                return index + 2;
+            }
+            Add("K");
+            return At(index + 1) == 'G' ? index + 2 : index + 1;
+        }
+
+        auto HandleGH(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (index > 0 && !IsVowel(At(index - 1)))
+            {
+                Add("K");
+                return index + 2;
+            }
+            if (index == 0)
+            {
+                Add(At(index + 2) == 'I' ? "J" : "K");
+                return index + 2;
+            }
+            if ((index > 1 && Is(index - 2, { "B", "H", "D" })) || (index > 2 && Is(index - 3, { "B", "H", "D" })) ||
+                (index > 3 && Is(index - 4, { "B", "H" })))
+            {
+                // Parker's rule: "hugh"
+                return index + 2;
+            }
+            if (index > 2 && At(index - 1) == 'U' && Is(index - 3, { "C", "G", "L", "R", "T" }))
+                Add("F"); // "laugh", "cough", "rough", "tough"
+            else if (At(index - 1) != 'I')
+                Add("K");
+            return index + 2;
+        }
+
+        auto HandleH(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            // Only kept when first or after a vowel, and before a vowel
+            if ((index == 0 || IsVowel(At(index - 1))) && IsVowel(At(index + 1)))
+            {
+                Add("H");
+                return index + 2;
+            }
+            return index + 1;
+        }
+
+        auto HandleJ(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (Is(index, { "JOSE" }))
+            {
+                // Spanish "Jose"
+                if (index == 0 && Size() == 4)
+                    Add("H");
+                else
+                    Add("J", "H");
+                return index + 1;
+            }
+            if (index == 0)
+                Add("J", "A");
+            else if (IsVowel(At(index - 1)) && !slavo_germanic && (At(index + 1) == 'A' || At(index + 1) == 'O'))
+                Add("J", "H");
+            else if (index == Size() - 1)
+                AddPrimary("J"); // Commons Codec adds a space to the alternate code here
+            else if (!Is(index + 1, { "L", "T", "K", "S", "N", "M", "B", "Z" }) && !Is(index - 1, { "S", "K", "L" }))
+                Add("J");
+            return At(index + 1) == 'J' ? index + 2 : index + 1;
+        }
+
+        auto HandleL(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (At(index + 1) == 'L')
+            {
+                if (ConditionL0(index))
+                    AddPrimary("L"); // Spanish "Cabrillo", "Gallegos"
+                else
+                    Add("L");
+                return index + 2;
+            }
+            Add("L");
+            return index + 1;
+        }
+
+        auto HandleP(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (At(index + 1) == 'H')
+            {
+                Add("F");
+                return index + 2;
+            }
+            Add("P");
+            return Is(index + 1, { "P", "B" }) ? index + 2 : index + 1;
+        }
+
+        auto HandleR(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            // French "Rogier"
+            if (index == Size() - 1 && !slavo_germanic && Is(index - 2, { "IE" }) && !Is(index - 4, { "ME", "MA" }))
+                AddAlternate("R");
+            else
+                Add("R");
+            return At(index + 1) == 'R' ? index + 2 : index + 1;
+        }
+
+        auto HandleS(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (Is(index - 1, { "ISL", "YSL" }))
+                return index + 1; // "island", "isle", "Carlisle"
+            if (index == 0 && Is(index, { "SUGAR" }))
+            {
+                Add("X", "S");
+                return index + 1;
+            }
+            if (Is(index, { "SH" }))
+            {
+                if (Is(index + 1, { "HEIM", "HOEK", "HOLM", "HOLZ" }))
+                    Add("S"); // Germanic
+                else
+                    Add("X");
+                return index + 2;
+            }
+            if (Is(index, { "SIO", "SIA" }) || Is(index, { "SIAN" }))
+            {
+                // Italian and Armenian
+                if (slavo_germanic)
+                    Add("S");
+                else
+                    Add("S", "X");
+                return index + 3;
+            }
+            if ((index == 0 && Is(index + 1, { "M", "N", "L", "W" })) || Is(index + 1, { "Z" }))
+            {
+                // Anglicised German, "Smith" matching "Schmidt", and Slavic "sz"
+                Add("S", "X");
+                return Is(index + 1, { "Z" }) ? index + 2 : index + 1;
+            }
+            if (Is(index, { "SC" }))
+                return HandleSC(index);
+            // French "Resnais", "Artois"
+            if (index == Size() - 1 && Is(index - 2, { "AI", "OI" }))
+                AddAlternate("S");
+            else
+                Add("S");
+            return Is(index + 1, { "S", "Z" }) ? index + 2 : index + 1;
+        }
+
+        auto HandleSC(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (At(index + 2) == 'H')
+            {
+                // Schlesinger's rule
+                if (Is(index + 3, { "OO", "ER", "EN", "UY", "ED", "EM" }))
+                {
+                    // Dutch "school", "schooner", "Schermerhorn"
+                    if (Is(index + 3, { "ER", "EN" }))
+                        Add("X", "SK");
+                    else
+                        Add("SK");
+                }
+                else if (index == 0 && !IsVowel(At(3)) && At(3) != 'W')
+                {
+                    Add("X", "S");
+                }
+                else
+                {
+                    Add("X");
+                }
+            }
+            else if (Is(index + 2, { "I", "E", "Y" }))
+            {
+                Add("S");
+            }
+            else
+            {
+                Add("SK");
+            }
+            return index + 3;
+        }
+
+        auto HandleT(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (Is(index, { "TION" }) || Is(index, { "TIA", "TCH" }))
+            {
+                Add("X");
+                return index + 3;
+            }
+            if (Is(index, { "TH" }) || Is(index, { "TTH" }))
+            {
+                // "Thomas", "Thames" or Germanic
+                if (Is(index + 2, { "OM", "AM" }) || Is(0, { "SCH" }))
+                    Add("T");
+                else
+                    Add("0", "T");
+                return index + 2;
+            }
+            Add("T");
+            return Is(index + 1, { "T", "D" }) ? index + 2 : index + 1;
+        }
+
+        auto HandleW(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (Is(index, { "WR" }))
+            {
+                Add("R");
+                return index + 2;
+            }
+            if (index == 0 && (IsVowel(At(index + 1)) || Is(index, { "WH" })))
+            {
+                // "Wasserman" matching "Vasserman", "Uomo" matching "Womo"
+                if (IsVowel(At(index + 1)))
+                    Add("A", "F");
+                else
+                    Add("A");
+                return index + 1;
+            }
+            if ((index == Size() - 1 && IsVowel(At(index - 1))) ||
+                Is(index - 1, { "EWSKI", "EWSKY", "OWSKI", "OWSKY" }) || Is(0, { "SCH" }))
+            {
+                // "Arnow" matching "Arnoff"
+                AddAlternate("F");
+                return index + 1;
+            }
+            if (Is(index, { "WICZ", "WITZ" }))
+            {
+                // Polish "Filipowicz"
+                Add("TS", "FX");
+                return index + 4;
+            }
+            return index + 1;
+        }
+
+        auto HandleX(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (index == 0)
+            {
+                Add("S");
+                return index + 1;
+            }
+            // French "Breaux"
+            if (!(index == Size() - 1 && (Is(index - 3, { "IAU", "EAU" }) || Is(index - 2, { "AU", "OU" }))))
+                Add("KS");
+            return Is(index + 1, { "C", "X" }) ? index + 2 : index + 1;
+        }
+
+        auto HandleZ(std::ptrdiff_t index) -> std::ptrdiff_t
+        {
+            if (At(index + 1) == 'H')
+            {
+                // Pinyin "Zhao"
+                Add("J");
+                return index + 2;
+            }
+            if (Is(index + 1, { "ZO", "ZI", "ZA" }) || (slavo_germanic && index > 0 && At(index - 1) != 'T'))
+                Add("S", "TS");
+            else
+                Add("S");
+            return At(index + 1) == 'Z' ? index + 2 : index + 1;
+        }
+
+        auto ConditionC0(std::ptrdiff_t index) const -> bool
+        {
+            if (Is(index, { "CHIA" }))
+                return true;
+            if (index <= 1 || IsVowel(At(index - 2)) || !Is(index - 1, { "ACH" }))
+                return false;
+            const auto next = At(index + 2);
+            return (next != 'I' && next != 'E') || Is(index - 2, { "BACHER", "MACHER" });
+        }
+
+        auto ConditionCH0(std::ptrdiff_t index) const -> bool
+        {
+            if (index != 0)
+                return false;
+            if (!Is(index + 1, { "HARAC", "HARIS" }) && !Is(index + 1, { "HOR", "HYM", "HIA", "HEM" }))
+                return false;
+            return !Is(0, { "CHORE" });
+        }
+
+        auto ConditionCH1(std::ptrdiff_t index) const -> bool
+        {
+            return Is(0, { "SCH" }) || Is(index - 2, { "ORCHES", "ARCHIT", "ORCHID" }) || Is(index + 2, { "T", "S" }) ||
+                   ((Is(index - 1, { "A", "O", "U", "E" }) || index == 0) &&
+                    (Is(index + 2, { "L", "R", "N", "M", "B", "H", "F", "V", "W" }) || index + 1 == Size() - 1));
+        }
+
+        auto ConditionL0(std::ptrdiff_t index) const -> bool
+        {
+            if (index == Size() - 3 && Is(index - 1, { "ILLO", "ILLA", "ALLE" }))
+                return true;
+            return (Is(Size() - 2, { "AS", "OS" }) || Is(Size() - 1, { "A", "O" })) && Is(index - 1, { "ALLE" });
+        }
+
+        auto ConditionM0(std::ptrdiff_t index) const -> bool
+        {
+            if (At(index + 1) == 'M')
+                return true;
+            return Is(index - 1, { "UMB" }) && (index + 1 == Size() - 1 || Is(index + 2, { "ER" }));
+        }
+    };
+};
@@ -0,0 +1,245 @@
+//
+// Bit-parallel Levenshtein distance (Myers, with Hyyrö's formulation), case insensitive.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace EditDistance
+{
+    static const std::size_t NO_LIMIT{ std::numeric_limits<std::size_t>::max() - 1 };
+
+    namespace Detail
+    {
+        static const std::size_t WORD_BITS{ 64 };
+
+        inline auto Fold(char c) -> unsigned char
+        {
+            return static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        // Mask of the lowest n bits
+        inline auto Bits(std::size_t n) -> std::uint64_t
+        {
+            return n >= WORD_BITS ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << n) - 1;
+        }
+    } // namespace Detail
+
+    // Textbook dynamic programming over a single row, as a reference and for very long strings.
+    inline auto ReferenceDistance(std::string_view a, std::string_view b) -> std::size_t
+    {
+        auto row = std::vector<std::size_t>(std::size(b) + 1);
+        for (std::size_t j = 0; j <= std::size(b); ++j)
+            row[j] = j;
+        for (std::size_t i = 1; i <= std::size(a); ++i)
+        {
+            auto diagonal = std::exchange(row[0], i);
+            for (std::size_t j = 1; j <= std::size(b); ++j)
+            {
+                const auto substitution = diagonal + (Detail::Fold(a[i - 1]) != Detail::Fold(b[j - 1]));
+                diagonal = row[j];
+                row[j] = std::min({ row[j] + 1, row[j - 1] + 1, substitution });
+            }
+        }
+        return row[std::size(b)];
+    }
+
+    // A string preprocessed into per character position masks, one bit per character,
+    // so its distance to any text takes a handful of word operations per text character
+    // and per 64 pattern characters, without allocating.
+    class Pattern
+    {
+        static constexpr std::size_t MAX_BLOCKS{ 4 };
+
+    public:
+        static constexpr std::size_t MAX_SIZE{ MAX_BLOCKS * Detail::WORD_BITS };
+
+        Pattern() = default;
+
+        explicit Pattern(std::string_view pattern)
+        {
+            Assign(pattern);
+        }
+
+        // Reuses this pattern for another string, only clearing the masks it had set.
+        // Strings longer than MAX_SIZE are only viewed, so they must outlive the pattern.
+        auto Assign(std::string_view pattern) -> void
+        {
+            for (std::size_t j = 0; j < std::min(size_, MAX_SIZE); ++j)
+                masks_[static_cast<unsigned char>(folded_[j])] = {};
+            long_pattern_ = pattern;
+            size_ = std::size(pattern);
+            if (size_ > MAX_SIZE)
+                return;
+            for (std::size_t j = 0; j < size_; ++j)
+            {
+                const auto c = Detail::Fold(pattern[j]);
+                folded_[j] = static_cast<char>(c);
+                masks_[c][j / Detail::WORD_BITS] |= std::uint64_t{ 1 } << (j % Detail::WORD_BITS);
+            }
+        }
+
+        auto Size() const -> std::size_t
+        {
+            return size_;
+        }
+
+        // Levenshtein distance to text. Once it is bound to exceed max_distance,
+        // stops early and returns max_distance + 1.
+        auto Distance(std::string_view text, std::size_t max_distance = NO_LIMIT) const -> std::size_t
+        {
+            const auto length_difference = std::max(size_, std::size(text)) - std::min(size_, std::size(text));
+            if (length_difference > max_distance)
+                return max_distance + 1;
+            if (size_ > MAX_SIZE)
+                return std::min(ReferenceDistance(long_pattern_, text), max_distance + 1);
+            if (size_ == 0)
+                return std::size(text);
+
+            const auto blocks = (size_ + Detail::WORD_BITS - 1) / Detail::WORD_BITS;
+            const auto last_bit = std::uint64_t{ 1 } << ((size_ - 1) % Detail::WORD_BITS);
+            auto positive = std::array<std::uint64_t, MAX_BLOCKS>{}; // Vertical +1 deltas
+            auto negative = std::array<std::uint64_t, MAX_BLOCKS>{}; // Vertical -1 deltas
+            positive.fill(~std::uint64_t{ 0 });
+            auto score = size_;
+            for (std::size_t i = 0; i < std::size(text); ++i)
+            {
+                const auto& masks = masks_[Detail::Fold(text[i])];
+                auto carry = 1; // Horizontal delta entering the block, +1 along the first row
+                for (std::size_t b = 0; b < blocks; ++b)
+                {
+                    const auto high_bit = b + 1 == blocks ? last_bit : std::uint64_t{ 1 } << (Detail::WORD_BITS - 1);
+                    carry = AdvanceBlock(masks[b], positive[b], negative[b], carry, high_bit);
+                }
+                score = static_cast<std::size_t>(static_cast<long long>(score) + carry);
+                // Every remaining text character can lower the distance by one at most
+                const auto remaining = std::size(text) - i - 1;
+                if (score > remaining && score - remaining > max_distance)
+                    return max_distance + 1;
+            }
+            return std::min(score, max_distance + 1);
+        }
+
+    private:
+        // One column step for a 64 row block; returns the horizontal delta leaving its last row.
+        static auto AdvanceBlock(std::uint64_t equal, std::uint64_t& positive, std::uint64_t& negative, int carry_in,
+                                 std::uint64_t high_bit) -> int
+        {
+            const auto vertical = equal | negative;
+            if (carry_in < 0)
+                equal |= 1;
+            const auto horizontal = (((equal & positive) + positive) ^ positive) | equal;
+            auto horizontal_positive = negative | ~(horizontal | positive);
+            auto horizontal_negative = positive & horizontal;
+            const auto carry_out = (horizontal_positive & high_bit) ? 1 : (horizontal_negative & high_bit) ? -1 : 0;
+            horizontal_positive <<= 1;
+            horizontal_negative <<= 1;
+            if (carry_in < 0)
+                horizontal_negative |= 1;
+            else if (carry_in > 0)
+                horizontal_positive |= 1;
+            positive = horizontal_negative | ~(vertical | horizontal_positive);
+            negative = horizontal_positive & vertical;
+            return carry_out;
+        }
+
+        std::size_t size_{ 0 };
+        std::array<char, MAX_SIZE> folded_{};
+        std::string_view long_pattern_;
+        std::array<std::array<std::uint64_t, MAX_BLOCKS>, 256> masks_{};
+    };
+
+    inline auto Distance(std::string_view a, std::string_view b) -> std::size_t
+    {
+        return Pattern{ a }.Distance(b);
+    }
+
+    // Distances from query to each of count candidates, written to distances.
+    //
+    // Short candidates are packed side by side into one 64-bit word, each in its own
+    // lane, and the query is run once against the whole word: the additions are done
+    // lane-wise so no carry crosses a lane boundary, and each lane's distance is read
+    // off its final vertical deltas. Eight 8-letter names thus cost one pass over the
+    // query. Candidates longer than a word are scored one at a time.
+    inline auto Distances(std::string_view query, const std::string_view* candidates, std::size_t count,
+                          std::uint32_t* distances) -> void
+    {
+        auto query_pattern = Pattern{};
+        auto query_assigned = false;
+        auto masks = std::array<std::uint64_t, 256>{};
+        for (std::size_t first = 0; first < count;)
+        {
+            // Pack as many candidates as fit in a word
+            auto lanes_start = std::uint64_t{ 0 };
+            auto lanes_top = std::uint64_t{ 0 };
+            auto used = std::size_t{ 0 };
+            auto last = first;
+            for (; last < count && used + std::size(candidates[last]) <= Detail::WORD_BITS; ++last)
+            {
+                const auto candidate = candidates[last];
+                if (candidate.empty())
+                    continue;
+                for (std::size_t j = 0; j < std::size(candidate); ++j)
+                    masks[Detail::Fold(candidate[j])] |= std::uint64_t{ 1 } << (used + j);
+                lanes_start |= std::uint64_t{ 1 } << used;
+                lanes_top |= std::uint64_t{ 1 } << (used + std::size(candidate) - 1);
+                used += std::size(candidate);
+            }
+            if (last == first)
+            {
+                // Too long to share a word
+                if (!std::exchange(query_assigned, true))
+                    query_pattern.Assign(query);
+                distances[first] = static_cast<std::uint32_t>(query_pattern.Distance(candidates[first]));
+                ++first;
+                continue;
+            }
+
+            auto positive = ~std::uint64_t{ 0 };
+            auto negative = std::uint64_t{ 0 };
+            for (const auto c : query)
+            {
+                auto equal = masks[Detail::Fold(c)];
+                const auto vertical = equal | negative;
+                const auto both = equal & positive;
+                const auto sum = ((both & ~lanes_top) + (positive & ~lanes_top)) ^ ((both ^ positive) & lanes_top);
+                const auto horizontal = (sum ^ positive) | equal;
+                auto horizontal_positive = negative | ~(horizontal | positive);
+                auto horizontal_negative = positive & horizontal;
+                horizontal_positive = (horizontal_positive << 1) | lanes_start;
+                horizontal_negative = (horizontal_negative << 1) & ~lanes_start;
+                positive = horizontal_negative | ~(vertical | horizontal_positive);
+                negative = horizontal_positive & vertical;
+            }
+
+            // The last column starts at |query| on row 0 and changes by the vertical deltas below
+            auto offset = std::size_t{ 0 };
+            for (auto k = first; k < last; ++k)
+            {
+                const auto candidate = candidates[k];
+                if (candidate.empty())
+                {
+                    // No lane, and offset may already be the word size
+                    distances[k] = static_cast<std::uint32_t>(std::size(query));
+                    continue;
+                }
+                for (const auto c : candidate)
+                    masks[Detail::Fold(c)] = 0;
+                const auto lane = Detail::Bits(std::size(candidate)) << offset;
+                offset += std::size(candidate);
+                const auto up = static_cast<std::size_t>(__builtin_popcountll(positive & lane));
+                const auto down = static_cast<std::size_t>(__builtin_popcountll(negative & lane));
+                distances[k] = static_cast<std::uint32_t>(std::size(query) + up - down);
+            }
+            first = last;
+        }
+    }
+} // namespace EditDistance
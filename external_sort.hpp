@@ -0,0 +1,425 @@
+//
+// Out-of-core sort of names by Soundex code, for inputs larger than memory.
+//
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "radix_sort.hpp"
+#include "soundex.hpp"
+#include "soundex_code.hpp"
+
+// Reads newline separated names and writes "CODE\tname" lines sorted by code,
+// keeping input order within a code.
+//
+// Input that fits in the memory budget is sorted in memory. Otherwise records are
+// distributed by code rank range into spill files, each of which is then sorted in
+// memory, or split again if it is still too large. A spill file holding a single
+// code is already grouped and is copied through. All file I/O is sequential.
+namespace ExternalSort
+{
+    struct Options
+    {
+        // Approximate bound on the bytes held in memory at any time
+        std::size_t memory_budget{ std::size_t{ 256 } << 20 };
+        // Number of spill files a too large input is split into, per level; fewer if
+        // the budget cannot buffer that many
+        std::size_t fanout{ 64 };
+        std::filesystem::path spill_directory{ std::filesystem::temp_directory_path() };
+    };
+
+    struct Stats
+    {
+        std::size_t records{ 0 };
+        std::size_t rejected{ 0 }; // Names that cannot be encoded, skipped
+        std::size_t spill_files{ 0 };
+        std::size_t spilled_bytes{ 0 };
+    };
+
+    namespace Detail
+    {
+        // "CODE\t" prefix of every formatted record
+        static const std::size_t PREFIX_SIZE{ 5 };
+
+        struct RankRange
+        {
+            std::size_t begin;
+            std::size_t end;
+
+            auto Size() const -> std::size_t
+            {
+                return end - begin;
+            }
+        };
+
+        inline auto RankOf(std::string_view record) -> std::size_t
+        {
+            return SoundexCode::FromString(record.substr(0, PREFIX_SIZE - 1)).Rank();
+        }
+
+        // Memory an in-memory sort needs per record, on top of the record itself
+        inline auto RecordOverhead() -> std::size_t
+        {
+            return 2 * (sizeof(std::string_view) + sizeof(SoundexCode)) + sizeof(std::size_t);
+        }
+
+        // Formatted records sorted in memory, one after the other in an arena
+        class SortBuffer
+        {
+        public:
+            // Bytes of the arena, unused capacity included, and of sorting its records
+            auto Bytes() const -> std::size_t
+            {
+                return arena_.capacity() + count_ * RecordOverhead();
+            }
+
+            auto Reserve(std::size_t bytes) -> void
+            {
+                arena_.reserve(bytes);
+            }
+
+            // Adds record unless the buffer would then take more than limit bytes. The
+            // arena grows geometrically, but not past its share of the limit at the
+            // current average record size, since its unused capacity counts too.
+            auto TryAdd(std::string_view record, std::size_t limit) -> bool
+            {
+                const auto size = std::size(arena_) + std::size(record);
+                const auto overhead = (count_ + 1) * RecordOverhead();
+                if (std::max(size, arena_.capacity()) + overhead > limit)
+                    return false;
+                if (size > arena_.capacity())
+                {
+                    const auto share = static_cast<std::size_t>(static_cast<double>(limit) *
+                                                                static_cast<double>(size) /
+                                                                static_cast<double>(size + overhead));
+                    arena_.reserve(std::clamp(2 * arena_.capacity(), size, std::max(size, share)));
+                }
+                arena_.insert(std::end(arena_), std::begin(record), std::end(record));
+                ++count_;
+                return true;
+            }
+
+            // Every record ends with a newline
+            template <typename Fn>
+            auto ForEach(Fn fn) const -> void
+            {
+                const auto text = std::string_view{ std::data(arena_), std::size(arena_) };
+                for (auto begin = std::size_t{ 0 }; begin < std::size(text);)
+                {
+                    const auto end = text.find('\n', begin) + 1;
+                    fn(text.substr(begin, end - begin));
+                    begin = end;
+                }
+            }
+
+            // Writes the records unsorted, in the order they were added
+            auto Write(std::ostream& output) const -> void
+            {
+                output.write(std::data(arena_), static_cast<std::streamsize>(std::size(arena_)));
+            }
+
+            auto SortAndWrite(std::ostream& output) -> void
+            {
+                auto records = std::vector<std::string_view>{};
+                auto codes = std::vector<SoundexCode>{};
+                records.reserve(count_);
+                codes.reserve(count_);
+                ForEach(
+                    [&](std::string_view record)
+                    {
+                        records.push_back(record);
+                        codes.push_back(SoundexCode::FromRank(RankOf(record)));
+                    });
+                RadixSort::SortByCode(records, codes);
+                for (const auto record : records)
+                    output.write(std::data(record), static_cast<std::streamsize>(std::size(record)));
+            }
+
+            auto Clear() -> void
+            {
+                arena_.clear();
+                arena_.shrink_to_fit();
+                count_ = 0;
+            }
+
+        private:
+            // A vector, since std::string::reserve may round the capacity up
+            std::vector<char> arena_;
+            std::size_t count_{ 0 };
+        };
+
+        // Owns a fresh directory for the spill files and removes it when done.
+        class SpillDirectory
+        {
+        public:
+            explicit SpillDirectory(const std::filesystem::path& parent)
+            {
+                auto random = std::random_device{};
+                do
+                    path_ = parent / ("soundex-sort-" + std::to_string(random()));
+                while (!std::filesystem::create_directory(path_));
+            }
+
+            SpillDirectory(const SpillDirectory&) = delete;
+            auto operator=(const SpillDirectory&) -> SpillDirectory& = delete;
+
+            ~SpillDirectory()
+            {
+                auto error = std::error_code{};
+                std::filesystem::remove_all(path_, error);
+            }
+
+            auto NewFile() -> std::filesystem::path
+            {
+                return path_ / (std::to_string(next_file_++) + ".spill");
+            }
+
+        private:
+            std::filesystem::path path_;
+            std::size_t next_file_{ 0 };
+        };
+
+        struct Partition
+        {
+            RankRange ranks;
+            std::filesystem::path path;
+            std::size_t records{ 0 };
+            std::size_t bytes{ 0 };
+        };
+
+        // Splits a rank range into spill files, each behind its own write buffer. The
+        // buffers together take half the memory budget, allocated up front and never
+        // grown, and the streams have none of their own; fewer files are used when the
+        // budget cannot give each of them MIN_BUFFER_SIZE bytes.
+        class Partitioner
+        {
+        public:
+            static constexpr std::size_t MIN_BUFFER_SIZE{ 512 };
+
+            Partitioner(RankRange ranks, const Options& options, SpillDirectory& directory, Stats& stats)
+                : ranks_{ ranks }, stats_{ stats }
+            {
+                const auto affordable = options.memory_budget / (2 * MIN_BUFFER_SIZE);
+                const auto fanout = std::clamp<std::size_t>(std::min(options.fanout, affordable), 2, ranks.Size());
+                buffer_size_ = std::max<std::size_t>(1, options.memory_budget / (2 * fanout));
+                files_ = std::vector<std::ofstream>(fanout);
+                for (std::size_t i = 0; i < fanout; ++i)
+                {
+                    // Partition i holds the ranks whose index below is i
+                    const auto begin = ranks.begin + (ranks.Size() * i + fanout - 1) / fanout;
+                    const auto end = ranks.begin + (ranks.Size() * (i + 1) + fanout - 1) / fanout;
+                    partitions_.push_back(Partition{ RankRange{ begin, end }, directory.NewFile() });
+                    files_[i].rdbuf()->pubsetbuf(nullptr, 0);
+                    files_[i].open(partitions_.back().path, std::ios::binary);
+                    if (!files_[i])
+                        throw std::runtime_error("Cannot create spill file: " + partitions_.back().path.string());
+                    buffers_.emplace_back().reserve(buffer_size_);
+                }
+                stats_.spill_files += fanout;
+            }
+
+            // Bytes of all the write buffers when full
+            auto BufferBytes() const -> std::size_t
+            {
+                return std::size(buffers_) * buffer_size_;
+            }
+
+            auto Add(std::string_view record) -> void
+            {
+                const auto index = (RankOf(record) - ranks_.begin) * std::size(partitions_) / ranks_.Size();
+                ++partitions_[index].records;
+                partitions_[index].bytes += std::size(record);
+                if (std::size(buffers_[index]) + std::size(record) > buffer_size_)
+                {
+                    Flush(index);
+                    if (std::size(record) > buffer_size_)
+                    {
+                        Write(index, record);
+                        return;
+                    }
+                }
+                buffers_[index].append(record);
+            }
+
+            // Writes out what is buffered and releases the buffers and the files
+            auto Finish() -> std::vector<Partition>
+            {
+                for (std::size_t index = 0; index < std::size(partitions_); ++index)
+                {
+                    Flush(index);
+                    files_[index].close();
+                    if (!files_[index])
+                        throw std::runtime_error("Cannot write spill file: " + partitions_[index].path.string());
+                }
+                buffers_.clear();
+                buffers_.shrink_to_fit();
+                files_.clear();
+                files_.shrink_to_fit();
+                return std::move(partitions_);
+            }
+
+        private:
+            auto Flush(std::size_t index) -> void
+            {
+                Write(index, buffers_[index]);
+                buffers_[index].clear();
+            }
+
+            auto Write(std::size_t index, std::string_view bytes) -> void
+            {
+                files_[index].write(std::data(bytes), static_cast<std::streamsize>(std::size(bytes)));
+                stats_.spilled_bytes += std::size(bytes);
+            }
+
+            RankRange ranks_;
+            Stats& stats_;
+            std::size_t buffer_size_{ 0 };
+            std::vector<Partition> partitions_;
+            std::vector<std::ofstream> files_;
+            std::vector<std::string> buffers_;
+        };
+
+        // Calls fn for every line of a spill file, newline included.
+        template <typename Fn>
+        auto ForEachRecord(const std::filesystem::path& path, Fn fn) -> void
+        {
+            auto file = std::ifstream{ path, std::ios::binary };
+            if (!file)
+                throw std::runtime_error("Cannot open spill file: " + path.string());
+            auto line = std::string{};
+            while (std::getline(file, line))
+            {
+                line.push_back('\n');
+                fn(std::string_view{ line });
+            }
+            if (file.bad() || !file.eof())
+                throw std::runtime_error("Cannot read spill file: " + path.string());
+        }
+
+        inline auto ProcessPartition(const Partition& partition, std::ostream& output, const Options& options,
+                                     SpillDirectory& directory, Stats& stats) -> void
+        {
+            if (partition.bytes + partition.records * RecordOverhead() <= options.memory_budget)
+            {
+                auto buffer = SortBuffer{};
+                buffer.Reserve(partition.bytes);
+                ForEachRecord(partition.path,
+                              [&](std::string_view record)
+                              {
+                                  buffer.TryAdd(record, options.memory_budget);
+                              });
+                buffer.SortAndWrite(output);
+            }
+            else if (partition.ranks.Size() == 1)
+            {
+                // A single code: already grouped, and in input order
+                ForEachRecord(partition.path,
+                              [&output](std::string_view record)
+                              {
+                                  output.write(std::data(record), static_cast<std::streamsize>(std::size(record)));
+                              });
+            }
+            else
+            {
+                // The partitioner is gone before the children are processed, so levels
+                // do not add up
+                const auto children = [&]
+                {
+                    auto partitioner = Partitioner{ partition.ranks, options, directory, stats };
+                    ForEachRecord(partition.path,
+                                  [&partitioner](std::string_view record)
+                                  {
+                                      partitioner.Add(record);
+                                  });
+                    return partitioner.Finish();
+                }();
+                std::filesystem::remove(partition.path); // Free the disk space before going deeper
+                for (const auto& child : children)
+                    ProcessPartition(child, output, options, directory, stats);
+            }
+            std::filesystem::remove(partition.path);
+        }
+    } // namespace Detail
+
+    inline auto SortByCode(std::istream& input, std::ostream& output, const Options& options = {}) -> Stats
+    {
+        auto stats = Stats{};
+        auto buffer = Detail::SortBuffer{};
+        auto directory = std::optional<Detail::SpillDirectory>{};
+        auto partitioner = std::optional<Detail::Partitioner>{};
+        const auto all_ranks = Detail::RankRange{ 0, SoundexCode::RANK_COUNT };
+
+        auto name = std::string{};
+        auto record = std::string{};
+        while (std::getline(input, name))
+        {
+            if (!name.empty() && name.back() == '\r')
+                name.pop_back();
+            const auto code = Soundex::TryEncodePacked(name);
+            if (!code.has_value())
+            {
+                ++stats.rejected;
+                continue;
+            }
+            ++stats.records;
+            record = code->ToString() + '\t' + name + '\n';
+
+            if (partitioner.has_value())
+            {
+                partitioner->Add(record);
+            }
+            else if (!buffer.TryAdd(record, options.memory_budget))
+            {
+                // Does not fit. What was buffered is written out as it is and released
+                // before the partition buffers are allocated, then partitioned from disk
+                // ahead of the rest of the input, keeping input order within a code.
+                directory.emplace(options.spill_directory);
+                const auto pending = directory->NewFile();
+                {
+                    auto file = std::ofstream{ pending, std::ios::binary };
+                    buffer.Write(file);
+                    if (!file.flush())
+                        throw std::runtime_error("Cannot write spill file: " + pending.string());
+                }
+                stats.spilled_bytes += std::filesystem::file_size(pending);
+                ++stats.spill_files;
+                buffer.Clear();
+                partitioner.emplace(all_ranks, options, *directory, stats);
+                Detail::ForEachRecord(pending,
+                                      [&partitioner](std::string_view buffered)
+                                      {
+                                          partitioner->Add(buffered);
+                                      });
+                std::filesystem::remove(pending);
+                partitioner->Add(record);
+            }
+        }
+
+        if (!partitioner.has_value())
+        {
+            buffer.SortAndWrite(output);
+        }
+        else
+        {
+            const auto partitions = partitioner->Finish();
+            partitioner.reset();
+            for (const auto& partition : partitions)
+                Detail::ProcessPartition(partition, output, options, *directory, stats);
+        }
+        if (!output)
+            throw std::runtime_error("Cannot write sorted output");
+        return stats;
+    }
+} // namespace ExternalSort
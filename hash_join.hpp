@@ -0,0 +1,328 @@
+//
+// Phonetic equi-join of two name datasets on their Soundex code.
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "radix_sort.hpp"
+#include "soundex.hpp"
+#include "soundex_code.hpp"
+
+// The smaller (build) side is loaded into a hash table keyed by code and split
+// into 2^partition_bits radix partitions. The larger (probe) side is streamed
+// through it in batches; each thread radix partitions its share of a batch the
+// same way, so the probes for one partition only touch that partition's table.
+namespace HashJoin
+{
+    struct Pair
+    {
+        std::uint32_t build_id; // Position in the build side
+        std::uint64_t probe_id; // Position in the probe stream
+    };
+
+    // Codes hash to 32 bits, but more partitions than codes only add empty tables
+    inline constexpr std::size_t MAX_PARTITION_BITS{ 16 };
+
+    struct Options
+    {
+        std::size_t thread_count{ 0 }; // 0 is one per hardware thread
+        std::size_t partition_bits{ 6 }; // At most MAX_PARTITION_BITS
+        // Upper bound on the pairs emitted for a single code, 0 for no bound.
+        // Protects the output against giant buckets such as "S530".
+        std::uint64_t max_pairs_per_code{ 0 };
+        // Probe records read from a stream and processed together
+        std::size_t batch_size{ std::size_t{ 1 } << 16 };
+    };
+
+    struct Stats
+    {
+        std::uint64_t build_records{ 0 };
+        std::uint64_t build_rejected{ 0 }; // Names that cannot be encoded are left out
+        std::uint64_t probe_records{ 0 };
+        std::uint64_t probe_rejected{ 0 };
+        std::uint64_t pairs{ 0 };
+        std::uint64_t truncated_pairs{ 0 }; // Dropped by max_pairs_per_code
+    };
+
+    class JoinTable
+    {
+        static constexpr std::size_t FLUSH_SIZE{ 4096 };
+
+        struct Bucket
+        {
+            std::uint32_t begin{ 0 };
+            std::uint32_t count{ 0 }; // 0 marks an empty slot
+            std::uint16_t packed{ 0 };
+        };
+
+        struct PartitionTable
+        {
+            std::size_t mask{ 0 }; // Slot count - 1
+            std::vector<Bucket> slots;
+        };
+
+    public:
+        JoinTable(const std::vector<std::string_view>& build_names, const Options& options)
+            : options_{ options }, partitions_(PartitionCount(options.partition_bits))
+        {
+            const auto thread_count = Parallel::ThreadCount(options_.thread_count);
+            auto valid = std::vector<std::uint8_t>(std::size(build_names));
+            auto codes = std::vector<SoundexCode>(std::size(build_names));
+            Parallel::ForEachChunk(std::size(build_names), thread_count,
+                                   [&](std::size_t, std::size_t begin, std::size_t end)
+                                   {
+                                       for (auto i = begin; i < end; ++i)
+                                       {
+                                           const auto code = Soundex::TryEncodePacked(build_names[i]);
+                                           valid[i] = code.has_value();
+                                           codes[i] = code.value_or(SoundexCode{});
+                                       }
+                                   });
+
+            auto row_codes = std::vector<SoundexCode>{};
+            for (std::size_t i = 0; i < std::size(build_names); ++i)
+            {
+                if (!valid[i])
+                    continue;
+                rows_.push_back(static_cast<std::uint32_t>(i));
+                row_codes.push_back(codes[i]);
+            }
+            stats_.build_records = std::size(rows_);
+            stats_.build_rejected = std::size(build_names) - std::size(rows_);
+
+            // Rows grouped by code, then by partition, so each partition's rows are contiguous
+            RadixSort::SortByCode(rows_, row_codes);
+            auto partition_rows = std::vector<std::uint32_t>(std::size(rows_));
+            auto partition_codes = std::vector<SoundexCode>(std::size(rows_));
+            auto offsets = std::vector<std::size_t>(std::size(partitions_) + 1, 0);
+            for (const auto code : row_codes)
+                ++offsets[PartitionOf(code) + 1];
+            for (std::size_t p = 1; p < std::size(offsets); ++p)
+                offsets[p] += offsets[p - 1];
+            auto cursor = offsets;
+            for (std::size_t i = 0; i < std::size(rows_); ++i)
+            {
+                const auto destination = cursor[PartitionOf(row_codes[i])]++;
+                partition_rows[destination] = rows_[i];
+                partition_codes[destination] = row_codes[i];
+            }
+            rows_.swap(partition_rows);
+
+            for (std::size_t p = 0; p < std::size(partitions_); ++p)
+                BuildPartition(p, partition_codes, offsets[p], offsets[p + 1]);
+            emitted_ = std::vector<std::atomic<std::uint64_t>>(bucket_count_);
+        }
+
+        // Joins a batch of probe names, whose ids start at first_probe_id.
+        // sink(const Pair*, std::size_t) is called with chunks of pairs, never concurrently.
+        template <typename Sink>
+        auto Probe(const std::vector<std::string_view>& probe_names, std::uint64_t first_probe_id, Sink& sink) -> void
+        {
+            auto sink_mutex = std::mutex{};
+            Parallel::ForEachChunk(
+                std::size(probe_names), options_.thread_count,
+                [&](std::size_t, std::size_t begin, std::size_t end)
+                {
+                    auto probes = std::vector<std::pair<SoundexCode, std::uint64_t>>{};
+                    auto rejected = std::uint64_t{ 0 };
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        const auto code = Soundex::TryEncodePacked(probe_names[i]);
+                        if (code.has_value())
+                            probes.emplace_back(*code, first_probe_id + i);
+                        else
+                            ++rejected;
+                    }
+                    auto partitioned = PartitionProbes(probes);
+
+                    auto pairs = std::vector<Pair>{};
+                    pairs.reserve(FLUSH_SIZE);
+                    const auto flush = [&]
+                    {
+                        const auto lock = std::scoped_lock{ sink_mutex };
+                        sink(std::data(pairs), std::size(pairs));
+                        pairs.clear();
+                    };
+                    auto emitted = std::uint64_t{ 0 };
+                    auto truncated = std::uint64_t{ 0 };
+                    for (const auto& [code, probe_id] : partitioned)
+                    {
+                        const auto* bucket = Find(code);
+                        if (bucket == nullptr)
+                            continue;
+                        auto count = std::uint64_t{ bucket->count };
+                        if (options_.max_pairs_per_code != 0)
+                        {
+                            const auto already = emitted_[BucketIndex(bucket)].fetch_add(count);
+                            const auto allowed =
+                                already >= options_.max_pairs_per_code ? 0 : options_.max_pairs_per_code - already;
+                            truncated += count - std::min(count, allowed);
+                            count = std::min(count, allowed);
+                        }
+                        for (std::uint64_t r = 0; r < count; ++r)
+                        {
+                            pairs.push_back(Pair{ rows_[bucket->begin + r], probe_id });
+                            if (std::size(pairs) == FLUSH_SIZE)
+                                flush();
+                        }
+                        emitted += count;
+                    }
+                    if (!pairs.empty())
+                        flush();
+
+                    probe_records_ += std::size(probes);
+                    probe_rejected_ += rejected;
+                    pairs_ += emitted;
+                    truncated_pairs_ += truncated;
+                });
+        }
+
+        auto GetStats() const -> Stats
+        {
+            auto stats = stats_;
+            stats.probe_records = probe_records_;
+            stats.probe_rejected = probe_rejected_;
+            stats.pairs = pairs_;
+            stats.truncated_pairs = truncated_pairs_;
+            return stats;
+        }
+
+    private:
+        static auto PartitionCount(std::size_t partition_bits) -> std::size_t
+        {
+            if (partition_bits > MAX_PARTITION_BITS)
+                throw std::invalid_argument("At most " + std::to_string(MAX_PARTITION_BITS) + " partition bits");
+            return std::size_t{ 1 } << partition_bits;
+        }
+
+        static auto Hash(SoundexCode code) -> std::uint32_t
+        {
+            return static_cast<std::uint32_t>(code.Packed()) * 0x9E3779B1u;
+        }
+
+        auto PartitionOf(SoundexCode code) const -> std::size_t
+        {
+            return options_.partition_bits == 0 ? 0 : Hash(code) >> (32 - options_.partition_bits);
+        }
+
+        auto BuildPartition(std::size_t p, const std::vector<SoundexCode>& codes, std::size_t begin, std::size_t end)
+            -> void
+        {
+            auto distinct = std::size_t{ 0 };
+            for (auto i = begin; i < end; ++i)
+                distinct += (i == begin || codes[i] != codes[i - 1]);
+            auto slot_count = std::size_t{ 1 };
+            while (slot_count < 2 * distinct)
+                slot_count <<= 1;
+
+            auto& table = partitions_[p];
+            table.mask = slot_count - 1;
+            table.slots.assign(slot_count, Bucket{});
+            for (auto i = begin; i < end;)
+            {
+                auto group_end = i;
+                while (group_end < end && codes[group_end] == codes[i])
+                    ++group_end;
+                auto slot = Hash(codes[i]) & table.mask;
+                while (table.slots[slot].count != 0)
+                    slot = (slot + 1) & table.mask;
+                table.slots[slot] = Bucket{ static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(group_end - i),
+                                            codes[i].Packed() };
+                i = group_end;
+            }
+            bucket_offsets_.push_back(bucket_count_);
+            bucket_count_ += slot_count;
+        }
+
+        auto Find(SoundexCode code) const -> const Bucket*
+        {
+            const auto& table = partitions_[PartitionOf(code)];
+            if (table.slots.empty())
+                return nullptr;
+            for (auto slot = Hash(code) & table.mask;; slot = (slot + 1) & table.mask)
+            {
+                const auto& bucket = table.slots[slot];
+                if (bucket.count == 0)
+                    return nullptr;
+                if (bucket.packed == code.Packed())
+                    return &bucket;
+            }
+        }
+
+        // Global index of a bucket, for the per code pair counters
+        auto BucketIndex(const Bucket* bucket) const -> std::size_t
+        {
+            const auto p = PartitionOf(SoundexCode::FromPacked(bucket->packed));
+            return bucket_offsets_[p] + static_cast<std::size_t>(bucket - std::data(partitions_[p].slots));
+        }
+
+        // Stable counting sort of a thread's probes by build partition
+        auto PartitionProbes(const std::vector<std::pair<SoundexCode, std::uint64_t>>& probes) const
+            -> std::vector<std::pair<SoundexCode, std::uint64_t>>
+        {
+            auto offsets = std::vector<std::size_t>(std::size(partitions_) + 1, 0);
+            for (const auto& probe : probes)
+                ++offsets[PartitionOf(probe.first) + 1];
+            for (std::size_t p = 1; p < std::size(offsets); ++p)
+                offsets[p] += offsets[p - 1];
+            auto partitioned = std::vector<std::pair<SoundexCode, std::uint64_t>>(std::size(probes));
+            for (const auto& probe : probes)
+                partitioned[offsets[PartitionOf(probe.first)]++] = probe;
+            return partitioned;
+        }
+
+        Options options_;
+        Stats stats_;
+        std::vector<std::uint32_t> rows_; // Build ids, grouped by partition then code
+        std::vector<PartitionTable> partitions_;
+        std::vector<std::size_t> bucket_offsets_;
+        std::size_t bucket_count_{ 0 };
+        std::vector<std::atomic<std::uint64_t>> emitted_;
+        std::atomic<std::uint64_t> probe_records_{ 0 };
+        std::atomic<std::uint64_t> probe_rejected_{ 0 };
+        std::atomic<std::uint64_t> pairs_{ 0 };
+        std::atomic<std::uint64_t> truncated_pairs_{ 0 };
+    };
+
+    // Joins build_names against newline separated names read from probe_input.
+    // Probe ids are line numbers, counting from 0, including lines that cannot be encoded.
+    template <typename Sink>
+    auto Join(const std::vector<std::string_view>& build_names, std::istream& probe_input, Sink sink,
+              const Options& options = {}) -> Stats
+    {
+        auto table = JoinTable{ build_names, options };
+        auto lines = std::vector<std::string>{};
+        auto batch = std::vector<std::string_view>{};
+        auto first_probe_id = std::uint64_t{ 0 };
+        auto line = std::string{};
+        const auto probe_batch = [&]
+        {
+            batch.assign(std::begin(lines), std::end(lines));
+            table.Probe(batch, first_probe_id, sink);
+            first_probe_id += std::size(lines);
+            lines.clear();
+        };
+        while (std::getline(probe_input, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            lines.push_back(std::move(line));
+            if (std::size(lines) == options.batch_size)
+                probe_batch();
+        }
+        if (!lines.empty())
+            probe_batch();
+        return table.GetStats();
+    }
+} // namespace HashJoin
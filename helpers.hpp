@@ -5,51 +5,55 @@
 //
 #pragma once
 
-#include <algorithm>
+#include <cstddef>
 #include <string>
-#include <vector>
+#include <string_view>
 
+// Views and single letters, so none of these allocate, and constexpr, so each
+// translation unit shares one inline definition.
 namespace Helpers
 {
-    static auto Head(const std::string& word) -> std::string
+    constexpr auto Head(std::string_view word) -> std::string_view
     {
         return word.substr(0, 1);
     }
 
-    static auto Tail(const std::string& word) -> std::string
+    constexpr auto Tail(std::string_view word) -> std::string_view
     {
         return word.substr(1);
     }
 
-    static auto ToUppercase(const std::string& word) -> std::string
+    // ASCII letters only
+    constexpr auto ToUppercase(char letter) -> char
     {
-        return std::string(1, static_cast<char>(std::toupper(static_cast<unsigned char>(word.front()))));
+        return letter >= 'a' && letter <= 'z' ? static_cast<char>(letter - 'a' + 'A') : letter;
     }
 
-    static auto IsConsonant(char letter) -> bool
+    constexpr auto IsConsonant(char letter) -> bool
     {
         // We do not consider 'y' to be a vowel here
-        letter = static_cast<char>(std::tolower(letter));
-        const auto vowels = std::vector<char>{ 'a', 'e', 'i', 'o', 'u' };
-        return std::find(std::begin(vowels), std::end(vowels), tolower(letter)) == std::end(vowels);
+        return std::string_view{ "aeiouAEIOU" }.find(letter) == std::string_view::npos;
     }
 
-    static auto IsVowel(char letter) -> bool
+    constexpr auto IsVowel(char letter) -> bool
     {
         // Given it is alphabetic, it must be consonant or vowel
         return !IsConsonant(letter);
     }
 
-    static auto ConsonantShouldBeIgnored(const char letter) -> bool
+    constexpr auto ConsonantShouldBeIgnored(const char letter) -> bool
     {
-        const auto ignored_consonants = std::vector<char>{ 'w', 'h', 'y', 'W', 'H', 'Y' };
-        return std::find(std::begin(ignored_consonants), std::end(ignored_consonants), letter) !=
-               std::end(ignored_consonants);
+        return std::string_view{ "whyWHY" }.find(letter) != std::string_view::npos;
     }
 
-    static auto PadWithZeros(const std::string& word, std::size_t desired_size) -> std::string
+    // Pads word in place; allocates only if it does not already have the capacity
+    inline auto PadWithZeros(std::string& word, std::size_t desired_size) -> void
     {
-        const auto zeros_needed = desired_size - word.length();
-        return std::string{ word } + std::string(zeros_needed, '0');
+        if (std::size(word) < desired_size)
+            word.resize(desired_size, '0');
     }
+
+    static_assert(Head("Robert") == "R" && Tail("Robert") == "obert");
+    static_assert(ToUppercase('r') == 'R' && ToUppercase('R') == 'R');
+    static_assert(IsConsonant('y') && IsVowel('E') && ConsonantShouldBeIgnored('H'));
 } // namespace Helpers
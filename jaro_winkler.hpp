@@ -0,0 +1,177 @@
+//
+// Jaro-Winkler string similarity, case insensitive over ASCII letters.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace JaroWinkler
+{
+    // Winkler's prefix scale, and the Jaro score from which the prefix boost applies
+    static const double PREFIX_SCALE{ 0.1 };
+    static const double BOOST_THRESHOLD{ 0.7 };
+    static const std::size_t MAX_PREFIX{ 4 };
+
+    namespace Detail
+    {
+        inline auto Fold(char c) -> unsigned char
+        {
+            return static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        inline auto Combine(std::string_view a, std::string_view b, std::size_t matches, std::size_t transpositions)
+            -> double
+        {
+            if (matches == 0)
+                return 0.0;
+            const auto m = static_cast<double>(matches);
+            const auto jaro = (m / static_cast<double>(std::size(a)) + m / static_cast<double>(std::size(b)) +
+                               (m - static_cast<double>(transpositions / 2)) / m) /
+                              3.0;
+            if (jaro < BOOST_THRESHOLD)
+                return jaro;
+            auto prefix = std::size_t{ 0 };
+            const auto prefix_limit = std::min({ MAX_PREFIX, std::size(a), std::size(b) });
+            while (prefix < prefix_limit && Fold(a[prefix]) == Fold(b[prefix]))
+                ++prefix;
+            return jaro + static_cast<double>(prefix) * PREFIX_SCALE * (1.0 - jaro);
+        }
+
+        inline auto Window(std::size_t a_size, std::size_t b_size) -> std::size_t
+        {
+            const auto longest = std::max(a_size, b_size);
+            return longest < 4 ? 0 : longest / 2 - 1;
+        }
+
+        // Textbook quadratic version, for strings too long for a Pattern
+        inline auto ScalarSimilarity(std::string_view a, std::string_view b) -> double
+        {
+            if (a.empty() && b.empty())
+                return 1.0;
+            const auto window = Window(std::size(a), std::size(b));
+            auto a_matched = std::vector<bool>(std::size(a), false);
+            auto b_matched = std::vector<bool>(std::size(b), false);
+            auto matches = std::size_t{ 0 };
+            for (std::size_t i = 0; i < std::size(a); ++i)
+            {
+                const auto begin = i > window ? i - window : 0;
+                const auto end = std::min(std::size(b), i + window + 1);
+                for (auto j = begin; j < end; ++j)
+                {
+                    if (b_matched[j] || Fold(a[i]) != Fold(b[j]))
+                        continue;
+                    a_matched[i] = b_matched[j] = true;
+                    ++matches;
+                    break;
+                }
+            }
+            auto transpositions = std::size_t{ 0 };
+            auto j = std::size_t{ 0 };
+            for (std::size_t i = 0; i < std::size(a); ++i)
+            {
+                if (!a_matched[i])
+                    continue;
+                while (!b_matched[j])
+                    ++j;
+                transpositions += Fold(a[i]) != Fold(b[j]);
+                ++j;
+            }
+            return Combine(a, b, matches, transpositions);
+        }
+    } // namespace Detail
+
+    // One side of a comparison, preprocessed into per character position masks so it can
+    // be scored against many candidates. Matching then takes one AND per character of
+    // the candidate instead of a scan of the match window.
+    class Pattern
+    {
+    public:
+        static constexpr std::size_t MAX_SIZE{ 64 };
+
+        Pattern() = default;
+
+        explicit Pattern(std::string_view pattern)
+        {
+            Assign(pattern);
+        }
+
+        // Reuses this pattern for another string, without touching the whole mask table.
+        // Strings longer than MAX_SIZE are only viewed, so they must outlive the pattern.
+        auto Assign(std::string_view pattern) -> void
+        {
+            for (std::size_t j = 0; j < std::min(size_, MAX_SIZE); ++j)
+                masks_[static_cast<unsigned char>(folded_[j])] = 0;
+            long_pattern_ = pattern;
+            size_ = std::size(pattern);
+            if (size_ > MAX_SIZE)
+                return;
+            for (std::size_t j = 0; j < size_; ++j)
+            {
+                const auto c = Detail::Fold(pattern[j]);
+                folded_[j] = static_cast<char>(c);
+                masks_[c] |= std::uint64_t{ 1 } << j;
+            }
+        }
+
+        auto Similarity(std::string_view text) const -> double
+        {
+            if (size_ > MAX_SIZE)
+                return Detail::ScalarSimilarity(text, long_pattern_);
+            const auto pattern = std::string_view{ std::data(folded_), size_ };
+            if (text.empty() && pattern.empty())
+                return 1.0;
+
+            const auto window = Detail::Window(std::size(text), size_);
+            auto matched = std::uint64_t{ 0 };
+            auto matched_text = std::array<unsigned char, MAX_SIZE>{};
+            auto matches = std::size_t{ 0 };
+            for (std::size_t i = 0; i < std::size(text) && matches < size_; ++i)
+            {
+                if (i > window + size_)
+                    break;
+                const auto begin = i > window ? i - window : 0;
+                const auto end = std::min(size_, i + window + 1);
+                const auto in_window = Bits(end) & ~Bits(begin);
+                const auto c = Detail::Fold(text[i]);
+                const auto candidates = masks_[c] & in_window & ~matched;
+                if (candidates == 0)
+                    continue;
+                matched |= candidates & (~candidates + 1);
+                matched_text[matches++] = c;
+            }
+
+            // Matched pattern characters in order, against matched text characters in order
+            auto transpositions = std::size_t{ 0 };
+            for (std::size_t k = 0; matched != 0; ++k, matched &= matched - 1)
+            {
+                const auto j = static_cast<std::size_t>(__builtin_ctzll(matched));
+                transpositions += static_cast<unsigned char>(pattern[j]) != matched_text[k];
+            }
+            return Detail::Combine(text, pattern, matches, transpositions);
+        }
+
+    private:
+        // Mask of the lowest n bits
+        static auto Bits(std::size_t n) -> std::uint64_t
+        {
+            return n >= 64 ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << n) - 1;
+        }
+
+        std::size_t size_{ 0 };
+        std::array<char, MAX_SIZE> folded_{};
+        std::string_view long_pattern_;
+        std::array<std::uint64_t, 256> masks_{};
+    };
+
+    inline auto Similarity(std::string_view a, std::string_view b) -> double
+    {
+        return Pattern{ b }.Similarity(a);
+    }
+} // namespace JaroWinkler
@@ -0,0 +1,113 @@
+//
+// Command line front end of RecordLinkage::Link.
+//
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "daitch_mokotoff.hpp"
+#include "double_metaphone.hpp"
+#include "nysiis.hpp"
+#include "record_linkage.hpp"
+#include "refined_soundex.hpp"
+#include "soundex.hpp"
+
+namespace
+{
+    auto PrintUsage() -> void
+    {
+        std::cerr << "Usage: soundex_linkage LEFT.csv RIGHT.csv [options] > matches.csv\n"
+                     "  --surname-column N    column holding the surname (default 0)\n"
+                     "  --given-column N      column holding the given name (default 1)\n"
+                     "  --no-given-name       block on the surname code alone\n"
+                     "  --encoder NAME        soundex, american-soundex, daitch-mokotoff, double-metaphone,\n"
+                     "                        nysiis or refined-soundex (default soundex)\n"
+                     "  --initials N          given name letters in the blocking key (default 1)\n"
+                     "  --threshold X         minimum score written (default 0.85)\n"
+                     "  --threads N           worker threads, 0 for all (default 0)\n"
+                     "  --no-header           the files have no header row\n";
+    }
+
+    // Each encoder gets its own instantiation of Link, so the choice is made once here
+    auto Link(std::string_view encoder, std::istream& left, std::istream& right, const RecordLinkage::Options& options)
+        -> RecordLinkage::Stats
+    {
+        if (encoder == "soundex")
+            return RecordLinkage::Link<PhoneticEncoder::Cached<Soundex>>(left, right, std::cout, options);
+        if (encoder == "american-soundex")
+            return RecordLinkage::Link<PhoneticEncoder::Cached<BasicSoundex<4, SoundexRules::American>>>(
+                left, right, std::cout, options);
+        if (encoder == "daitch-mokotoff")
+            return RecordLinkage::Link<PhoneticEncoder::Cached<DaitchMokotoff>>(left, right, std::cout, options);
+        if (encoder == "double-metaphone")
+            return RecordLinkage::Link<PhoneticEncoder::Cached<DoubleMetaphone>>(left, right, std::cout, options);
+        if (encoder == "nysiis")
+            return RecordLinkage::Link<PhoneticEncoder::Cached<Nysiis>>(left, right, std::cout, options);
+        if (encoder == "refined-soundex")
+            return RecordLinkage::Link<PhoneticEncoder::Cached<RefinedSoundex>>(left, right, std::cout, options);
+        throw std::invalid_argument("Unknown encoder " + std::string{ encoder });
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    auto options = RecordLinkage::Options{};
+    auto encoder = std::string{ "soundex" };
+    try
+    {
+        for (int i = 3; i < argc; ++i)
+        {
+            const auto argument = std::string_view{ argv[i] };
+            const auto value = [&]
+            {
+                if (i + 1 == argc)
+                    throw std::invalid_argument("Missing value for " + std::string{ argument });
+                return std::string{ argv[++i] };
+            };
+            if (argument == "--surname-column")
+                options.surname_column = std::stoul(value());
+            else if (argument == "--given-column")
+                options.given_name_column = std::stoul(value());
+            else if (argument == "--no-given-name")
+                options.given_name_column.reset();
+            else if (argument == "--encoder")
+                encoder = value();
+            else if (argument == "--initials")
+                options.initials = std::stoul(value());
+            else if (argument == "--threshold")
+                options.threshold = std::stod(value());
+            else if (argument == "--threads")
+                options.thread_count = std::stoul(value());
+            else if (argument == "--no-header")
+                options.has_header = false;
+            else
+                throw std::invalid_argument("Unknown option " + std::string{ argument });
+        }
+        options.compare_columns = { options.surname_column };
+        if (options.given_name_column.has_value())
+            options.compare_columns.push_back(*options.given_name_column);
+
+        auto left = std::ifstream{ argv[1] };
+        auto right = std::ifstream{ argv[2] };
+        if (!left || !right)
+            throw std::runtime_error("Cannot open input files");
+        const auto stats = Link(encoder, left, right, options);
+        std::cerr << stats.left_records << " left and " << stats.right_records << " right records, "
+                  << stats.rejected << " rejected, " << stats.candidate_pairs << " candidate pairs, "
+                  << stats.matches << " matches\n";
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+}
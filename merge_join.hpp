@@ -0,0 +1,178 @@
+//
+// Streaming sort-merge join of two inputs already sorted by Soundex code.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "soundex_code.hpp"
+
+// Both inputs hold "CODE\tname" lines sorted by code, as written by
+// ExternalSort::SortByCode. Each input is read once, front to back. Only the
+// current group of equal codes from the left input is held, in a buffer reused
+// from group to group, so memory grows with the largest code group of the left
+// input, not with the input sizes.
+namespace MergeJoin
+{
+    struct Record
+    {
+        SoundexCode code;
+        std::string_view name; // Only valid during the sink call
+        std::uint64_t line;    // Line number in its input, counting from 1
+    };
+
+    struct Stats
+    {
+        // Records read; reading stops once either input is exhausted
+        std::uint64_t left_records{ 0 };
+        std::uint64_t right_records{ 0 };
+        std::uint64_t groups{ 0 }; // Codes present in both inputs
+        std::uint64_t pairs{ 0 };
+    };
+
+    namespace Detail
+    {
+        class SortedReader
+        {
+        public:
+            explicit SortedReader(std::istream& input) : input_{ input }
+            {
+                Next();
+            }
+
+            auto Valid() const -> bool
+            {
+                return valid_;
+            }
+
+            auto Current() const -> Record
+            {
+                return Record{ code_, std::string_view{ line_ }.substr(5), line_number_ };
+            }
+
+            auto Code() const -> SoundexCode
+            {
+                return code_;
+            }
+
+            auto Records() const -> std::uint64_t
+            {
+                return records_;
+            }
+
+            auto Next() -> void
+            {
+                valid_ = static_cast<bool>(std::getline(input_, line_));
+                if (!valid_)
+                    return;
+                ++line_number_;
+                ++records_;
+                if (!line_.empty() && line_.back() == '\r')
+                    line_.pop_back();
+                if (std::size(line_) < 5 || line_[4] != '\t')
+                    throw std::runtime_error("Expected \"CODE\\tname\" on line " + std::to_string(line_number_));
+                const auto previous = code_;
+                code_ = SoundexCode::FromString(line_.substr(0, 4));
+                if (records_ > 1 && code_ < previous)
+                    throw std::runtime_error("Input is not sorted by code on line " + std::to_string(line_number_));
+            }
+
+        private:
+            std::istream& input_;
+            std::string line_;
+            std::uint64_t line_number_{ 0 };
+            std::uint64_t records_{ 0 };
+            SoundexCode code_;
+            bool valid_{ false };
+        };
+
+        // Names of the current left group, packed into one reusable buffer
+        class GroupBuffer
+        {
+        public:
+            auto Clear() -> void
+            {
+                names_.clear();
+                records_.clear();
+            }
+
+            auto Add(const Record& record) -> void
+            {
+                names_.append(record.name);
+                records_.emplace_back(std::size(names_), record.line);
+            }
+
+            template <typename Fn>
+            auto ForEach(SoundexCode code, Fn fn) const -> void
+            {
+                auto begin = std::size_t{ 0 };
+                for (const auto& [end, line] : records_)
+                {
+                    fn(Record{ code, std::string_view{ names_ }.substr(begin, end - begin), line });
+                    begin = end;
+                }
+            }
+
+            auto Size() const -> std::size_t
+            {
+                return std::size(records_);
+            }
+
+        private:
+            std::string names_;
+            std::vector<std::pair<std::size_t, std::uint64_t>> records_; // Name end, line
+        };
+    } // namespace Detail
+
+    // Calls sink(left, right) for every pair of records sharing a code, grouped by
+    // code in ascending order. Throws if either input is malformed or not sorted.
+    template <typename Sink>
+    auto Join(std::istream& left_input, std::istream& right_input, Sink sink) -> Stats
+    {
+        auto stats = Stats{};
+        auto left = Detail::SortedReader{ left_input };
+        auto right = Detail::SortedReader{ right_input };
+        auto group = Detail::GroupBuffer{};
+
+        while (left.Valid() && right.Valid())
+        {
+            if (left.Code() < right.Code())
+            {
+                left.Next();
+                continue;
+            }
+            if (right.Code() < left.Code())
+            {
+                right.Next();
+                continue;
+            }
+
+            const auto code = left.Code();
+            group.Clear();
+            for (; left.Valid() && left.Code() == code; left.Next())
+                group.Add(left.Current());
+            for (; right.Valid() && right.Code() == code; right.Next())
+            {
+                const auto right_record = right.Current();
+                group.ForEach(code,
+                              [&sink, &right_record](const Record& left_record)
+                              {
+                                  sink(left_record, right_record);
+                              });
+                stats.pairs += group.Size();
+            }
+            ++stats.groups;
+        }
+
+        stats.left_records = left.Records();
+        stats.right_records = right.Records();
+        return stats;
+    }
+} // namespace MergeJoin
@@ -0,0 +1,142 @@
+//
+// Several phonetic keys of a name computed together.
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "double_metaphone.hpp"
+#include "parallel.hpp"
+#include "soundex.hpp"
+#include "soundex_code.hpp"
+#include "unicode.hpp"
+
+// Soundex, a longer Soundex and Double Metaphone for the same names, reading each
+// name once instead of once per key.
+//
+// The long Soundex pass validates and classifies every letter; the four character
+// code is the prefix of the long one, and Double Metaphone runs on the word already
+// validated, so a name is checked once and classified once. Names that are not ASCII
+// are decoded once too: the Soundex pass keeps the letters it transliterates in a
+// buffer on the stack, which Double Metaphone reads.
+namespace MultiKey
+{
+    template <std::size_t LONG_SIZE = 8>
+    struct Keys
+    {
+        SoundexCode soundex;
+        BasicSoundexCode<LONG_SIZE> long_soundex;
+        DoubleMetaphone::Codes metaphone;
+    };
+
+    // Keys of a column of names, one array per key. Entries of rejected names are
+    // default codes, with valid set to 0.
+    template <std::size_t LONG_SIZE = 8>
+    struct Columns
+    {
+        std::vector<SoundexCode> soundex;
+        std::vector<BasicSoundexCode<LONG_SIZE>> long_soundex;
+        std::vector<DoubleMetaphoneCode> metaphone;
+        std::vector<DoubleMetaphoneCode> metaphone_alternate;
+        std::vector<std::uint8_t> valid;
+        std::size_t rejected{ 0 };
+    };
+
+    namespace Detail
+    {
+        // Letters of a name, read once: the long Soundex pass consumes them and the
+        // ASCII letters are kept in a buffer on the stack for Double Metaphone
+        class FoldingLetters
+        {
+        public:
+            static constexpr std::size_t CAPACITY{ 256 };
+
+            FoldingLetters(std::string_view word, std::array<char, CAPACITY>& folded, std::size_t& size)
+                : letters_{ word }, folded_{ folded }, size_{ size }
+            {
+            }
+
+            auto Next() -> int
+            {
+                const auto letter = letters_.Next();
+                if (letter != Unicode::END && size_ < CAPACITY)
+                    folded_[size_] = static_cast<char>(letter);
+                if (letter != Unicode::END)
+                    ++size_;
+                return letter;
+            }
+
+        private:
+            Unicode::Letters<char> letters_;
+            std::array<char, CAPACITY>& folded_;
+            std::size_t& size_;
+        };
+    } // namespace Detail
+
+    // Returns false, leaving keys untouched, if word is not allowed
+    template <std::size_t LONG_SIZE>
+    auto EncodeInto(std::string_view word, Keys<LONG_SIZE>& keys) -> bool
+    {
+        static_assert(LONG_SIZE >= SoundexCode::SIZE, "The long Soundex code must not be shorter");
+        auto long_soundex = BasicSoundexCode<LONG_SIZE>{};
+        if (Unicode::IsAscii(word))
+        {
+            using Letters = typename BasicSoundex<LONG_SIZE>::template AsciiLetters<char>;
+            if (!BasicSoundex<LONG_SIZE>::EncodeLetters(Letters{ word }, long_soundex))
+                return false;
+            DoubleMetaphone::EncodeLetters(word, keys.metaphone);
+        }
+        else
+        {
+            // Metaphone reads bytes, so it gets the ASCII letters the Soundex pass
+            // decoded; only names that fold to more letters than the buffer holds
+            // are folded again, into a string
+            auto folded = std::array<char, Detail::FoldingLetters::CAPACITY>{};
+            auto folded_size = std::size_t{ 0 };
+            if (!BasicSoundex<LONG_SIZE>::EncodeLetters(Detail::FoldingLetters{ word, folded, folded_size },
+                                                         long_soundex))
+                return false;
+            if (folded_size <= std::size(folded))
+                DoubleMetaphone::EncodeLetters(std::string_view{ std::data(folded), folded_size }, keys.metaphone);
+            else
+                DoubleMetaphone::EncodeLetters(*Unicode::FoldToAscii(word), keys.metaphone);
+        }
+        keys.long_soundex = long_soundex;
+        keys.soundex = long_soundex.template Prefix<SoundexCode::SIZE>();
+        return true;
+    }
+
+    template <std::size_t LONG_SIZE = 8>
+    auto EncodeColumns(const std::vector<std::string_view>& names, std::size_t thread_count = 1)
+        -> Columns<LONG_SIZE>
+    {
+        auto columns = Columns<LONG_SIZE>{};
+        columns.soundex.resize(std::size(names));
+        columns.long_soundex.resize(std::size(names));
+        columns.metaphone.resize(std::size(names));
+        columns.metaphone_alternate.resize(std::size(names));
+        columns.valid.resize(std::size(names));
+        Parallel::ForEachChunk(std::size(names), thread_count,
+                               [&](std::size_t, std::size_t begin, std::size_t end)
+                               {
+                                   auto keys = Keys<LONG_SIZE>{};
+                                   for (auto i = begin; i < end; ++i)
+                                   {
+                                       if (!EncodeInto(names[i], keys))
+                                           continue;
+                                       columns.soundex[i] = keys.soundex;
+                                       columns.long_soundex[i] = keys.long_soundex;
+                                       columns.metaphone[i] = keys.metaphone.primary;
+                                       columns.metaphone_alternate[i] = keys.metaphone.alternate;
+                                       columns.valid[i] = 1;
+                                   }
+                               });
+        for (const auto valid : columns.valid)
+            columns.rejected += valid == 0;
+        return columns;
+    }
+} // namespace MultiKey
@@ -0,0 +1,253 @@
+//
+// NYSIIS, the New York State Identification and Intelligence System phonetic code.
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "packed_code.hpp"
+
+struct NysiisAlphabet
+{
+    static constexpr std::string_view SYMBOLS{ "ABCDEFGHIJKLMNOPQRSTUVWXYZ" };
+};
+
+// A NYSIIS code of up to six letters, 5 bits each
+using NysiisCode = BasicPackedCode<NysiisAlphabet, 6>;
+
+// NYSIIS as in the Apache Commons Codec strict mode: codes are cut to six letters.
+//
+// The name is rewritten at its start and end, then transcoded letter by letter.
+// Transcoding may rewrite the next two letters too, so it runs over a window of
+// four letters instead of a copy of the name. Only the first eight key letters are
+// kept, which is enough for the final clean up of the key's end to give the same
+// six letters, so encoding does not allocate.
+class Nysiis
+{
+public:
+    using Code = NysiisCode;
+
+    static constexpr std::size_t MAX_CODES{ 1 };
+
+    // Returns false, leaving code untouched, if word is not allowed (empty or not
+    // only ASCII letters)
+    static auto EncodeInto(std::string_view word, Code& code) -> bool
+    {
+        if (word.empty())
+            return false;
+        for (const auto letter : word)
+            if (!IsLetter(letter))
+                return false;
+
+        const auto name = Name{ word };
+        const auto size = name.Size();
+        auto key = Key{};
+        key.Append(name.At(0));
+
+        auto window = std::array<char, 4>{ name.At(0), name.At(1), name.At(2), name.At(3) };
+        for (std::size_t i = 1; i < size; ++i)
+        {
+            const auto next = i + 1 < size ? window[2] : ' ';
+            const auto after_next = i + 2 < size ? window[3] : ' ';
+            Transcode(window[0], window, next, after_next);
+            if (window[1] != window[0])
+                key.Append(window[1]);
+            window = { window[1], window[2], window[3], i + 3 < size ? name.At(i + 3) : ' ' };
+        }
+
+        code = key.Finish();
+        return true;
+    }
+
+    static auto EncodeAll(std::string_view word, Code* codes) -> std::size_t
+    {
+        return EncodeInto(word, *codes) ? 1 : 0;
+    }
+
+    // Throws if word is not allowed
+    static auto Encode(const std::string& word) -> std::string
+    {
+        auto code = Code{};
+        if (!EncodeInto(word, code))
+            throw std::runtime_error("Invalid input: " + word);
+        return code.ToString();
+    }
+
+private:
+    static auto IsLetter(char letter) -> bool
+    {
+        const auto upper = letter & 0xDF;
+        return upper >= 'A' && upper <= 'Z';
+    }
+
+    static auto IsVowel(char letter) -> bool
+    {
+        return letter == 'A' || letter == 'E' || letter == 'I' || letter == 'O' || letter == 'U';
+    }
+
+    // The name, uppercase, after rewriting its first letters (MAC to MCC, KN to NN,
+    // K to C, PH and PF to FF, SCH to SSS) and its last ones (EE and IE to Y, then
+    // DT, RT, RD, NT and ND to D)
+    class Name
+    {
+    public:
+        explicit Name(std::string_view word) : word_{ word }, size_{ std::size(word) }
+        {
+            for (std::size_t i = 0; i < std::size(prefix_) && i < size_; ++i)
+                prefix_[i] = Original(i);
+            if (StartsWith("MAC"))
+                prefix_[1] = 'C';
+            else if (StartsWith("KN"))
+                prefix_[0] = 'N';
+            else if (StartsWith("K"))
+                prefix_[0] = 'C';
+            else if (StartsWith("PH") || StartsWith("PF"))
+                prefix_[0] = prefix_[1] = 'F';
+            else if (StartsWith("SCH"))
+                prefix_[1] = prefix_[2] = 'S';
+
+            if (EndsWith("EE") || EndsWith("IE"))
+                Shorten('Y');
+            if (EndsWith("DT") || EndsWith("RT") || EndsWith("RD") || EndsWith("NT") || EndsWith("ND"))
+                Shorten('D');
+        }
+
+        auto Size() const -> std::size_t
+        {
+            return size_;
+        }
+
+        // Letter at index, ' ' past the end
+        auto At(std::size_t index) const -> char
+        {
+            if (index >= size_)
+                return ' ';
+            if (last_.has_value() && index == size_ - 1)
+                return *last_;
+            if (index < std::size(prefix_))
+                return prefix_[index];
+            return Original(index);
+        }
+
+    private:
+        auto Original(std::size_t index) const -> char
+        {
+            return static_cast<char>(word_[index] & 0xDF);
+        }
+
+        auto StartsWith(std::string_view start) const -> bool
+        {
+            if (std::size(start) > size_)
+                return false;
+            for (std::size_t i = 0; i < std::size(start); ++i)
+                if (prefix_[i] != start[i])
+                    return false;
+            return true;
+        }
+
+        auto EndsWith(std::string_view end) const -> bool
+        {
+            if (std::size(end) > size_)
+                return false;
+            for (std::size_t i = 0; i < std::size(end); ++i)
+                if (At(size_ - std::size(end) + i) != end[i])
+                    return false;
+            return true;
+        }
+
+        // Replaces the last two letters with one
+        auto Shorten(char letter) -> void
+        {
+            --size_;
+            last_ = letter;
+        }
+
+        std::string_view word_;
+        std::size_t size_;
+        std::array<char, 3> prefix_{};
+        std::optional<char> last_;
+    };
+
+    // The first letters of the key, and how many there are in all
+    class Key
+    {
+    public:
+        auto Append(char letter) -> void
+        {
+            if (size_ < std::size(letters_))
+                letters_[size_] = letter;
+            ++size_;
+        }
+
+        // Drops a final 'S', turns a final "AY" into 'Y', drops a final 'A', and cuts
+        // the key to Code::SIZE letters. Once the key is longer than the letters kept,
+        // these changes are all past the letters that make the code.
+        auto Finish() -> Code
+        {
+            if (size_ > 1 && size_ <= std::size(letters_))
+            {
+                if (letters_[size_ - 1] == 'S')
+                    --size_;
+                if (size_ > 2 && letters_[size_ - 2] == 'A' && letters_[size_ - 1] == 'Y')
+                    letters_[--size_ - 1] = 'Y';
+                if (size_ > 0 && letters_[size_ - 1] == 'A')
+                    --size_;
+            }
+            auto code = Code{};
+            for (std::size_t i = 0; i < size_ && i < Code::SIZE; ++i)
+                code.Append(letters_[i]);
+            return code;
+        }
+
+    private:
+        std::array<char, Code::SIZE + 2> letters_{};
+        std::size_t size_{ 0 };
+    };
+
+    // Rewrites window[1], the current letter, and possibly the next two letters
+    static auto Transcode(char previous, std::array<char, 4>& window, char next, char after_next) -> void
+    {
+        const auto current = window[1];
+        if (current == 'E' && next == 'V')
+        {
+            window[1] = 'A';
+            window[2] = 'F';
+        }
+        else if (IsVowel(current))
+        {
+            window[1] = 'A';
+        }
+        else if (current == 'K' && next == 'N')
+        {
+            window[1] = 'N';
+            window[2] = 'N';
+        }
+        else if (current == 'S' && next == 'C' && after_next == 'H')
+        {
+            window[1] = 'S';
+            window[2] = 'S';
+            window[3] = 'S';
+        }
+        else if (current == 'P' && next == 'H')
+        {
+            window[1] = 'F';
+            window[2] = 'F';
+        }
+        else if ((current == 'H' && (!IsVowel(previous) || !IsVowel(next))) || (current == 'W' && IsVowel(previous)))
+        {
+            window[1] = previous;
+        }
+        else
+        {
+            window[1] = SIMPLE[static_cast<std::size_t>(current - 'A')];
+        }
+    }
+
+    // Q to G, Z to S, M to N and K to C; other letters are kept
+    static constexpr std::string_view SIMPLE{ "ABCDEFGHIJCLNNOPGRSTUVWXYS" };
+};
@@ -0,0 +1,173 @@
+//
+// Packed representation of variable length phonetic codes.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace PackedCode
+{
+    // Codes of at most this many bits have a dense rank: the packed value itself
+    inline constexpr std::size_t MAX_RANK_BITS{ 20 };
+
+    namespace Detail
+    {
+        constexpr auto BitsFor(std::size_t values) -> std::size_t
+        {
+            return values <= 1 ? 0 : 1 + BitsFor((values + 1) / 2);
+        }
+
+        template <std::size_t BITS, bool = (BITS <= MAX_RANK_BITS)>
+        struct RankCount
+        {
+        };
+
+        template <std::size_t BITS>
+        struct RankCount<BITS, true>
+        {
+            static constexpr std::size_t RANK_COUNT{ std::size_t{ 1 } << BITS };
+        };
+    } // namespace Detail
+} // namespace PackedCode
+
+// A code of up to N symbols from Alphabet::SYMBOLS, packed into an integer with a
+// fixed number of bits per symbol and 0 for no symbol, so shorter codes need no
+// length. Symbols are numbered in alphabet order; with an alphabet in ASCII order,
+// comparing packed values orders codes exactly like comparing their strings.
+//
+// Codes of up to PackedCode::MAX_RANK_BITS bits also have Rank(), FromRank() and
+// RANK_COUNT, so the indexes can find their buckets in a table.
+template <typename Alphabet, std::size_t N>
+class BasicPackedCode
+    : public PackedCode::Detail::RankCount<PackedCode::Detail::BitsFor(std::size(Alphabet::SYMBOLS) + 1) * N>
+{
+    static constexpr std::string_view SYMBOLS{ Alphabet::SYMBOLS };
+    static constexpr std::size_t SYMBOL_BITS{ PackedCode::Detail::BitsFor(std::size(SYMBOLS) + 1) };
+
+public:
+    static constexpr std::size_t SIZE{ N };
+    static constexpr std::size_t BITS{ SYMBOL_BITS * N };
+
+    static_assert(BITS <= 64, "The code does not fit 64 bits");
+
+    using Storage = std::conditional_t<BITS <= 16, std::uint16_t,
+                                       std::conditional_t<BITS <= 32, std::uint32_t, std::uint64_t>>;
+
+    BasicPackedCode() = default;
+
+    static auto FromPacked(Storage packed) -> BasicPackedCode
+    {
+        return BasicPackedCode{ packed };
+    }
+
+    static auto FromString(const std::string& code) -> BasicPackedCode
+    {
+        if (code.empty() || std::size(code) > SIZE)
+            throw std::runtime_error("Not a code: " + code);
+        auto packed = BasicPackedCode{};
+        for (const auto symbol : code)
+        {
+            if (SYMBOLS.find(symbol) == std::string_view::npos)
+                throw std::runtime_error("Not a code: " + code);
+            packed.Append(symbol);
+        }
+        return packed;
+    }
+
+    // Appends a symbol if there is room for it; symbol must be in the alphabet
+    auto Append(char symbol) -> void
+    {
+        const auto size = Size();
+        if (size == SIZE)
+            return;
+        const auto value = std::uint64_t{ SYMBOLS.find(symbol) + 1 };
+        packed_ = static_cast<Storage>(packed_ | (value << Shift(size)));
+    }
+
+    auto Size() const -> std::size_t
+    {
+        auto size = std::size_t{ 0 };
+        while (size < SIZE && Symbol(size) != 0)
+            ++size;
+        return size;
+    }
+
+    // Last symbol, '\0' if the code is empty
+    auto Back() const -> char
+    {
+        const auto size = Size();
+        return size == 0 ? '\0' : SYMBOLS[Symbol(size - 1) - 1];
+    }
+
+    auto PopBack() -> void
+    {
+        const auto size = Size();
+        if (size != 0)
+            packed_ = static_cast<Storage>(packed_ & ~(MASK << Shift(size - 1)));
+    }
+
+    auto Packed() const -> Storage
+    {
+        return packed_;
+    }
+
+    // Index in [0, RANK_COUNT), preserving code order
+    template <std::size_t B = BITS, typename = std::enable_if_t<(B <= PackedCode::MAX_RANK_BITS)>>
+    auto Rank() const -> std::size_t
+    {
+        return packed_;
+    }
+
+    template <std::size_t B = BITS, typename = std::enable_if_t<(B <= PackedCode::MAX_RANK_BITS)>>
+    static auto FromRank(std::size_t rank) -> BasicPackedCode
+    {
+        return BasicPackedCode{ static_cast<Storage>(rank) };
+    }
+
+    auto ToString() const -> std::string
+    {
+        auto code = std::string{};
+        for (std::size_t i = 0; i < Size(); ++i)
+            code.push_back(SYMBOLS[Symbol(i) - 1]);
+        return code;
+    }
+
+    friend auto operator==(BasicPackedCode lhs, BasicPackedCode rhs) -> bool
+    {
+        return lhs.packed_ == rhs.packed_;
+    }
+
+    friend auto operator!=(BasicPackedCode lhs, BasicPackedCode rhs) -> bool
+    {
+        return lhs.packed_ != rhs.packed_;
+    }
+
+    friend auto operator<(BasicPackedCode lhs, BasicPackedCode rhs) -> bool
+    {
+        return lhs.packed_ < rhs.packed_;
+    }
+
+private:
+    static constexpr std::uint64_t MASK{ (std::uint64_t{ 1 } << SYMBOL_BITS) - 1 };
+
+    explicit BasicPackedCode(Storage packed) : packed_{ packed }
+    {
+    }
+
+    static auto Shift(std::size_t position) -> std::size_t
+    {
+        return SYMBOL_BITS * (SIZE - 1 - position);
+    }
+
+    auto Symbol(std::size_t position) const -> std::size_t
+    {
+        return (std::size_t{ packed_ } >> Shift(position)) & MASK;
+    }
+
+    Storage packed_{ 0 };
+};
@@ -0,0 +1,64 @@
+//
+// Minimal fork-join helpers shared by the parallel algorithms.
+//
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace Parallel
+{
+    // Resolves a requested thread count, where 0 means "one per hardware thread".
+    inline auto ThreadCount(std::size_t requested) -> std::size_t
+    {
+        if (requested != 0)
+            return requested;
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Splits [0, size) into at most thread_count contiguous chunks and calls
+    // fn(chunk_index, begin, end) for each of them, one thread per chunk.
+    // Chunk boundaries only depend on size and thread_count, so consecutive
+    // calls with the same arguments see the same chunks.
+    // The first exception thrown by any chunk is rethrown once all have joined.
+    template <typename Fn>
+    auto ForEachChunk(std::size_t size, std::size_t thread_count, Fn fn) -> void
+    {
+        thread_count = std::max<std::size_t>(1, std::min(ThreadCount(thread_count), size));
+        const auto chunk_size = (size + thread_count - 1) / thread_count;
+        if (thread_count == 1)
+        {
+            fn(std::size_t{ 0 }, std::size_t{ 0 }, size);
+            return;
+        }
+
+        auto errors = std::vector<std::exception_ptr>(thread_count);
+        auto threads = std::vector<std::thread>{};
+        threads.reserve(thread_count);
+        for (std::size_t chunk = 0; chunk < thread_count; ++chunk)
+        {
+            const auto begin = std::min(size, chunk * chunk_size);
+            const auto end = std::min(size, begin + chunk_size);
+            threads.emplace_back(
+                [&fn, &errors, chunk, begin, end]
+                {
+                    try
+                    {
+                        fn(chunk, begin, end);
+                    }
+                    catch (...)
+                    {
+                        errors[chunk] = std::current_exception();
+                    }
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (const auto& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+    }
+} // namespace Parallel
@@ -0,0 +1,142 @@
+//
+// The compile-time interface shared by the phonetic encoders.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// A phonetic encoder is a class with only static members:
+//
+//   using Code = ...;                  a packed code: copyable, with ==, < and Packed()
+//   static constexpr std::size_t MAX_CODES;
+//   static auto EncodeAll(std::string_view word, Code* codes) -> std::size_t;
+//
+// EncodeAll writes between 1 and MAX_CODES codes for word and returns how many, or
+// returns 0 if word cannot be encoded. Soundex, DaitchMokotoff, DoubleMetaphone,
+// Nysiis and RefinedSoundex all qualify, and BatchEncode, CodeIndex,
+// BasicPhoneticIndex and RecordLinkage are templates over any encoder, so they call
+// it without virtual dispatch. Codes may also have a dense Rank() in [0, RANK_COUNT),
+// which lets an index find their buckets in a table.
+namespace PhoneticEncoder
+{
+    namespace Detail
+    {
+        template <typename Encoder, typename = void>
+        struct IsEncoder : std::false_type
+        {
+        };
+
+        template <typename Encoder>
+        struct IsEncoder<Encoder,
+                         std::void_t<typename Encoder::Code, decltype(Encoder::MAX_CODES),
+                                     decltype(Encoder::EncodeAll(std::declval<std::string_view>(),
+                                                                 std::declval<typename Encoder::Code*>())),
+                                     decltype(std::declval<typename Encoder::Code>().Packed()),
+                                     decltype(std::declval<typename Encoder::Code>() <
+                                              std::declval<typename Encoder::Code>())>>
+            : std::bool_constant<std::is_same_v<decltype(Encoder::EncodeAll(std::declval<std::string_view>(),
+                                                                            std::declval<typename Encoder::Code*>())),
+                                                std::size_t>>
+        {
+        };
+
+        template <typename Code, typename = void>
+        struct HasRank : std::false_type
+        {
+        };
+
+        template <typename Code>
+        struct HasRank<Code, std::void_t<decltype(Code::RANK_COUNT), decltype(std::declval<Code>().Rank())>>
+            : std::true_type
+        {
+        };
+    } // namespace Detail
+
+    template <typename Encoder>
+    inline constexpr bool IS_ENCODER{ Detail::IsEncoder<Encoder>::value };
+
+    template <typename Code>
+    inline constexpr bool HAS_RANK{ Detail::HasRank<Code>::value };
+
+    // First code of word, the primary one for encoders with several
+    template <typename Encoder>
+    auto EncodeFirst(std::string_view word) -> std::optional<typename Encoder::Code>
+    {
+        static_assert(IS_ENCODER<Encoder>, "Not a phonetic encoder");
+        auto codes = std::array<typename Encoder::Code, Encoder::MAX_CODES>{};
+        if (Encoder::EncodeAll(word, std::data(codes)) == 0)
+            return std::nullopt;
+        return codes.front();
+    }
+
+    // Encoder with a per-thread cache of recent names, for inputs where the same
+    // names come back often (surname columns). The cache is direct mapped on a hash
+    // of the name and holds names of up to MAX_NAME_SIZE characters; longer names
+    // are encoded every time. Cached is itself an encoder, so it plugs in wherever
+    // Encoder does.
+    template <typename Encoder, std::size_t CACHE_SIZE = 1024, std::size_t MAX_NAME_SIZE = 23>
+    class Cached
+    {
+        static_assert(IS_ENCODER<Encoder>, "Not a phonetic encoder");
+        static_assert((CACHE_SIZE & (CACHE_SIZE - 1)) == 0, "The cache size must be a power of two");
+        static_assert(MAX_NAME_SIZE < 0xFF, "Cached names must be shorter than 255 characters");
+
+    public:
+        using Code = typename Encoder::Code;
+
+        static constexpr std::size_t MAX_CODES{ Encoder::MAX_CODES };
+
+        static auto EncodeAll(std::string_view word, Code* codes) -> std::size_t
+        {
+            if (std::size(word) > MAX_NAME_SIZE)
+                return Encoder::EncodeAll(word, codes);
+
+            auto& entry = Entries()[Hash(word) & (CACHE_SIZE - 1)];
+            if (entry.size == std::size(word) && std::string_view{ std::data(entry.name), entry.size } == word)
+            {
+                std::copy(std::begin(entry.codes), std::begin(entry.codes) + entry.count, codes);
+                return entry.count;
+            }
+
+            const auto count = Encoder::EncodeAll(word, codes);
+            std::copy(std::begin(word), std::end(word), std::begin(entry.name));
+            entry.size = static_cast<std::uint8_t>(std::size(word));
+            entry.count = static_cast<std::uint8_t>(count);
+            std::copy(codes, codes + count, std::begin(entry.codes));
+            return count;
+        }
+
+    private:
+        static constexpr std::uint8_t EMPTY{ 0xFF };
+
+        struct Entry
+        {
+            std::array<char, MAX_NAME_SIZE> name{};
+            std::uint8_t size{ EMPTY };
+            std::uint8_t count{ 0 };
+            std::array<Code, MAX_CODES> codes{};
+        };
+
+        static auto Entries() -> std::array<Entry, CACHE_SIZE>&
+        {
+            thread_local auto entries = std::array<Entry, CACHE_SIZE>{};
+            return entries;
+        }
+
+        // FNV-1a
+        static auto Hash(std::string_view word) -> std::size_t
+        {
+            auto hash = std::size_t{ 14695981039346656037u };
+            for (const auto c : word)
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211u;
+            return hash ^ (hash >> 32);
+        }
+    };
+} // namespace PhoneticEncoder
@@ -0,0 +1,433 @@
+//
+// In-memory index of names bucketed by phonetic code, Soundex by default.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "batch_encode.hpp"
+#include "edit_distance.hpp"
+#include "parallel.hpp"
+#include "phonetic_encoder.hpp"
+#include "radix_sort.hpp"
+#include "soundex.hpp"
+#include "soundex_code.hpp"
+
+// Names are copied into one buffer in code order, so the names of a bucket sit next
+// to each other in memory, and their views form a contiguous range that kernels such
+// as EditDistance::Distances can consume directly. Buckets of codes with a dense
+// Rank() are found in a table indexed by rank; those of wider codes, such as NYSIIS
+// and Refined Soundex ones, by binary search among the codes present. A name with
+// several codes, as Daitch–Mokotoff and Double Metaphone give, is in the bucket of
+// each, copied once per bucket; lookups and searches return it once.
+template <typename Encoder = Soundex>
+class BasicPhoneticIndex
+{
+    static_assert(PhoneticEncoder::IS_ENCODER<Encoder>, "Not a phonetic encoder");
+
+    static constexpr std::size_t DIGIT_COUNT{ 3 };
+
+public:
+    using Code = typename Encoder::Code;
+
+    // A contiguous run of name views
+    class Range
+    {
+    public:
+        Range(const std::string_view* begin, const std::string_view* end) : begin_{ begin }, end_{ end }
+        {
+        }
+
+        auto begin() const -> const std::string_view*
+        {
+            return begin_;
+        }
+
+        auto end() const -> const std::string_view*
+        {
+            return end_;
+        }
+
+        auto data() const -> const std::string_view*
+        {
+            return begin_;
+        }
+
+        auto size() const -> std::size_t
+        {
+            return static_cast<std::size_t>(end_ - begin_);
+        }
+
+        auto empty() const -> bool
+        {
+            return begin_ == end_;
+        }
+
+    private:
+        const std::string_view* begin_;
+        const std::string_view* end_;
+    };
+
+    struct Match
+    {
+        std::string_view name;
+        std::uint32_t id; // Position in the input
+        double score;     // 1 - edit distance / length of the longer name
+    };
+
+    // Names that cannot be encoded are left out of the index
+    explicit BasicPhoneticIndex(const std::vector<std::string_view>& names, std::size_t thread_count = 1)
+    {
+        // One entry per code of each name
+        const auto column = BatchEncode::EncodeColumn<Encoder>(names, thread_count);
+        auto codes = std::vector<Code>{};
+        auto text_size = std::size_t{ 0 };
+        codes.reserve(std::size(column.codes));
+        ids_.reserve(std::size(column.codes));
+        for (std::size_t i = 0; i < std::size(names); ++i)
+        {
+            for (auto entry = column.offsets[i]; entry < column.offsets[i + 1]; ++entry)
+            {
+                ids_.push_back(static_cast<std::uint32_t>(i));
+                codes.push_back(column.codes[entry]);
+                text_size += std::size(names[i]);
+            }
+        }
+        rejected_ = column.rejected;
+        size_ = std::size(names) - rejected_;
+        if constexpr (std::is_same_v<Code, SoundexCode>)
+            RadixSort::ParallelSortByCode(ids_, codes, thread_count);
+        else if constexpr (DENSE)
+            SortByRank(ids_, codes);
+        else
+            SortByCode(ids_, codes);
+
+        // Views are taken once the buffer is complete, so they stay valid
+        text_.reserve(text_size);
+        for (const auto id : ids_)
+            text_.append(names[id]);
+        names_.reserve(std::size(ids_));
+        auto position = std::size_t{ 0 };
+        for (const auto id : ids_)
+        {
+            names_.push_back(std::string_view{ text_ }.substr(position, std::size(names[id])));
+            position += std::size(names[id]);
+        }
+
+        if constexpr (!DENSE)
+        {
+            codes_ = codes;
+            codes_.erase(std::unique(std::begin(codes_), std::end(codes_)), std::end(codes_));
+        }
+        const auto bucket_count = DENSE ? RankCount() : std::size(codes_);
+        offsets_.assign(bucket_count + 1, 0);
+        min_sizes_.assign(bucket_count, std::numeric_limits<std::uint32_t>::max());
+        max_sizes_.assign(bucket_count, 0);
+        for (std::size_t i = 0; i < std::size(codes); ++i)
+        {
+            const auto bucket = BucketIndex(codes[i]);
+            const auto size = static_cast<std::uint32_t>(std::size(names_[i]));
+            ++offsets_[bucket + 1];
+            min_sizes_[bucket] = std::min(min_sizes_[bucket], size);
+            max_sizes_[bucket] = std::max(max_sizes_[bucket], size);
+        }
+        for (std::size_t bucket = 1; bucket < std::size(offsets_); ++bucket)
+            offsets_[bucket] += offsets_[bucket - 1];
+    }
+
+    BasicPhoneticIndex(const BasicPhoneticIndex&) = delete;
+    auto operator=(const BasicPhoneticIndex&) -> BasicPhoneticIndex& = delete;
+
+    // Number of names indexed
+    auto Size() const -> std::size_t
+    {
+        return size_;
+    }
+
+    auto Rejected() const -> std::size_t
+    {
+        return rejected_;
+    }
+
+    auto Bucket(Code code) const -> Range
+    {
+        const auto bucket = BucketIndex(code);
+        if (bucket == NO_BUCKET)
+            return Range{ nullptr, nullptr };
+        const auto* names = std::data(names_);
+        return Range{ names + offsets_[bucket], names + offsets_[bucket + 1] };
+    }
+
+    // Bucket of the code of name, empty if name cannot be encoded. Names with several
+    // codes have several buckets, see LookupInto.
+    auto Lookup(std::string_view name) const -> Range
+    {
+        static_assert(Encoder::MAX_CODES == 1, "Names have several codes, use LookupInto");
+        auto code = Code{};
+        if (Encoder::EncodeAll(name, &code) == 0)
+            return Range{ nullptr, nullptr };
+        return Bucket(code);
+    }
+
+    // Positions in the input of the names sharing a code with name, in input order;
+    // empty if name cannot be encoded. The memory of ids is reused.
+    auto LookupInto(std::string_view name, std::vector<std::uint32_t>& ids) const -> void
+    {
+        ids.clear();
+        auto codes = std::array<Code, Encoder::MAX_CODES>{};
+        const auto count = Encoder::EncodeAll(name, std::data(codes));
+        for (std::size_t c = 0; c < count; ++c)
+        {
+            const auto bucket = BucketIndex(codes[c]);
+            if (bucket != NO_BUCKET)
+                ids.insert(std::end(ids), std::begin(ids_) + offsets_[bucket], std::begin(ids_) + offsets_[bucket + 1]);
+        }
+        if (count > 1)
+        {
+            std::sort(std::begin(ids), std::end(ids));
+            ids.erase(std::unique(std::begin(ids), std::end(ids)), std::end(ids));
+        }
+    }
+
+    // Position in the input of a name of this index
+    auto Id(const std::string_view* name) const -> std::uint32_t
+    {
+        return ids_[static_cast<std::size_t>(name - std::data(names_))];
+    }
+
+    // The k names most similar to query, best first, ties broken by input position.
+    //
+    // Probes the buckets of the query's codes and, for Soundex, their neighbours: the
+    // codes one digit away, and the codes whose first letter sounds alike. Buckets
+    // are visited by decreasing bound on the score their name lengths allow, and the
+    // search stops once no remaining bucket can beat the k-th best score so far. Within
+    // a bucket, the edit distance stops early past the distance the k-th score allows.
+    auto Search(std::string_view query, std::size_t k) const -> std::vector<Match>
+    {
+        auto matches = std::vector<Match>{};
+        auto codes = std::array<Code, Encoder::MAX_CODES>{};
+        const auto code_count = Encoder::EncodeAll(query, std::data(codes));
+        if (code_count == 0 || k == 0)
+            return matches;
+
+        auto probes = std::array<std::pair<double, std::size_t>, MAX_PROBES>{}; // Bound, bucket
+        auto probe_count = std::size_t{ 0 };
+        for (std::size_t c = 0; c < code_count; ++c)
+            ForEachNeighbour(codes[c],
+                             [&](Code neighbour)
+                             {
+                                 const auto bucket = BucketIndex(neighbour);
+                                 if (bucket != NO_BUCKET && offsets_[bucket] != offsets_[bucket + 1])
+                                     probes[probe_count++] = { BucketBound(bucket, std::size(query)), bucket };
+                             });
+        if (code_count > 1)
+        {
+            // Neighbours of different codes may be the same bucket
+            const auto by_bucket = [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; };
+            const auto same_bucket = [](const auto& lhs, const auto& rhs) { return lhs.second == rhs.second; };
+            const auto end = std::begin(probes) + static_cast<std::ptrdiff_t>(probe_count);
+            std::sort(std::begin(probes), end, by_bucket);
+            probe_count =
+                static_cast<std::size_t>(std::unique(std::begin(probes), end, same_bucket) - std::begin(probes));
+        }
+        std::sort(std::begin(probes), std::begin(probes) + static_cast<std::ptrdiff_t>(probe_count),
+                  [](const auto& lhs, const auto& rhs)
+                  {
+                      return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+                  });
+
+        // A heap with the worst kept match on top
+        const auto better = [](const Match& lhs, const Match& rhs)
+        {
+            return lhs.score > rhs.score || (lhs.score == rhs.score && lhs.id < rhs.id);
+        };
+        auto& heap = matches;
+        heap.reserve(k + 1);
+        const auto pattern = EditDistance::Pattern{ query };
+
+        for (std::size_t p = 0; p < probe_count; ++p)
+        {
+            const auto [bound, bucket] = probes[p];
+            if (std::size(heap) == k && bound < heap.front().score)
+                break;
+            for (auto i = offsets_[bucket]; i < offsets_[bucket + 1]; ++i)
+            {
+                const auto name = names_[i];
+                const auto longest = static_cast<double>(std::max(std::size(query), std::size(name)));
+                auto limit = EditDistance::NO_LIMIT;
+                if (std::size(heap) == k)
+                    limit = static_cast<std::size_t>((1.0 - heap.front().score) * longest + 1e-9);
+                const auto distance = pattern.Distance(name, limit);
+                if (distance > limit)
+                    continue;
+                // A name met again in another bucket of the query scores the same. If it
+                // is not kept, it did not score well enough then and does not now.
+                if (code_count > 1 && std::any_of(std::begin(heap), std::end(heap),
+                                                  [&](const Match& kept) { return kept.id == ids_[i]; }))
+                    continue;
+                const auto match = Match{ name, ids_[i], 1.0 - static_cast<double>(distance) / longest };
+                if (std::size(heap) == k)
+                {
+                    if (!better(match, heap.front()))
+                        continue;
+                    std::pop_heap(std::begin(heap), std::end(heap), better);
+                    heap.pop_back();
+                }
+                heap.push_back(match);
+                std::push_heap(std::begin(heap), std::end(heap), better);
+            }
+        }
+
+        std::sort_heap(std::begin(heap), std::end(heap), better);
+        return matches;
+    }
+
+private:
+    // Per code of the query: the code itself, and for Soundex 3 digits x 6 other
+    // values and up to 7 alike first letters
+    static constexpr std::size_t MAX_PROBES{ Encoder::MAX_CODES *
+                                             (std::is_same_v<Code, SoundexCode> ? 1 + DIGIT_COUNT * 6 + 7 : 1) };
+
+    static constexpr bool DENSE{ PhoneticEncoder::HAS_RANK<Code> };
+    static constexpr std::size_t NO_BUCKET{ std::numeric_limits<std::size_t>::max() };
+
+    static constexpr auto RankCount() -> std::size_t
+    {
+        if constexpr (DENSE)
+            return Code::RANK_COUNT;
+        else
+            return 0;
+    }
+
+    // Position of code's bucket in offsets_: its rank, or its position among the codes
+    // present; NO_BUCKET if no name has that code and it has no rank
+    auto BucketIndex(Code code) const -> std::size_t
+    {
+        if constexpr (DENSE)
+        {
+            return code.Rank();
+        }
+        else
+        {
+            const auto found = std::lower_bound(std::begin(codes_), std::end(codes_), code);
+            if (found == std::end(codes_) || *found != code)
+                return NO_BUCKET;
+            return static_cast<std::size_t>(found - std::begin(codes_));
+        }
+    }
+
+    // Stable counting sort of ids by code rank, for the codes RadixSort does not take
+    static auto SortByRank(std::vector<std::uint32_t>& ids, std::vector<Code>& codes) -> void
+    {
+        auto heads = std::vector<std::size_t>(RankCount() + 1, 0);
+        for (const auto code : codes)
+            ++heads[code.Rank() + 1];
+        for (std::size_t rank = 1; rank < std::size(heads); ++rank)
+            heads[rank] += heads[rank - 1];
+        auto sorted_ids = std::vector<std::uint32_t>(std::size(ids));
+        auto sorted_codes = std::vector<Code>(std::size(codes));
+        for (std::size_t i = 0; i < std::size(codes); ++i)
+        {
+            const auto destination = heads[codes[i].Rank()]++;
+            sorted_ids[destination] = ids[i];
+            sorted_codes[destination] = codes[i];
+        }
+        ids = std::move(sorted_ids);
+        codes = std::move(sorted_codes);
+    }
+
+    // Stable sort of ids by code, for codes without a rank
+    static auto SortByCode(std::vector<std::uint32_t>& ids, std::vector<Code>& codes) -> void
+    {
+        auto order = std::vector<std::size_t>(std::size(codes));
+        std::iota(std::begin(order), std::end(order), std::size_t{ 0 });
+        std::stable_sort(std::begin(order), std::end(order),
+                         [&codes](std::size_t lhs, std::size_t rhs) { return codes[lhs] < codes[rhs]; });
+        auto sorted_ids = std::vector<std::uint32_t>(std::size(ids));
+        auto sorted_codes = std::vector<Code>(std::size(codes));
+        for (std::size_t i = 0; i < std::size(order); ++i)
+        {
+            sorted_ids[i] = ids[order[i]];
+            sorted_codes[i] = codes[order[i]];
+        }
+        ids = std::move(sorted_ids);
+        codes = std::move(sorted_codes);
+    }
+
+    // The code itself, then for Soundex the codes one digit or one alike first letter away
+    template <typename Fn>
+    static auto ForEachNeighbour(Code code, Fn fn) -> void
+    {
+        fn(code);
+        if constexpr (std::is_same_v<Code, SoundexCode>)
+            ForEachSoundexNeighbour(code, fn);
+    }
+
+    template <typename Fn>
+    static auto ForEachSoundexNeighbour(SoundexCode code, Fn& fn) -> void
+    {
+        auto text = code.ToString();
+        for (std::size_t position = 1; position <= DIGIT_COUNT; ++position)
+        {
+            const auto digit = text[position];
+            for (auto other = '0'; other <= '6'; ++other)
+            {
+                if (other == digit)
+                    continue;
+                text[position] = other;
+                fn(SoundexCode::FromString(text));
+            }
+            text[position] = digit;
+        }
+
+        // Letters sharing a Soundex digit, and the uncoded ones, sound alike as a first letter
+        static const auto groups = std::array<std::string_view, 7>{ "AEIOUYHW", "BFPV", "CGJKQSXZ", "DT", "L",
+                                                                    "MN", "R" };
+        const auto first = text.front();
+        for (const auto group : groups)
+        {
+            if (group.find(first) == std::string_view::npos)
+                continue;
+            for (const auto letter : group)
+            {
+                if (letter == first)
+                    continue;
+                text.front() = letter;
+                fn(SoundexCode::FromString(text));
+            }
+        }
+    }
+
+    // Best score any name of the bucket could reach, from its length alone
+    auto BucketBound(std::size_t bucket, std::size_t query_size) const -> double
+    {
+        const auto closest = std::clamp<std::size_t>(query_size, min_sizes_[bucket], max_sizes_[bucket]);
+        const auto longest = std::max(query_size, closest);
+        if (longest == 0)
+            return 1.0;
+        const auto difference = std::max(query_size, closest) - std::min(query_size, closest);
+        return 1.0 - static_cast<double>(difference) / static_cast<double>(longest);
+    }
+
+    std::string text_;
+    std::vector<std::string_view> names_; // In code order, viewing text_
+    std::vector<std::uint32_t> ids_;      // Input position of each of names_
+    std::vector<Code> codes_;             // Codes present, in order, when codes have no rank
+    std::vector<std::uint32_t> offsets_;  // Start of each bucket in names_
+    std::vector<std::uint32_t> min_sizes_; // Shortest and longest name of each bucket
+    std::vector<std::uint32_t> max_sizes_;
+    std::size_t size_{ 0 };
+    std::size_t rejected_{ 0 };
+};
+
+using PhoneticIndex = BasicPhoneticIndex<>;
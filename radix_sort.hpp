@@ -0,0 +1,186 @@
+//
+// Counting/radix sort of records by their packed Soundex code.
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "soundex.hpp"
+#include "soundex_code.hpp"
+
+namespace RadixSort
+{
+    enum class Order
+    {
+        Stable,  // Records sharing a code keep their original relative order
+        Unstable // In place, without the scratch copy the stable sort needs
+    };
+
+    namespace Detail
+    {
+        static const std::size_t PASS_BITS{ 7 }; // Two passes cover the 14 bit code
+        static const std::size_t PASS_BUCKETS{ std::size_t{ 1 } << PASS_BITS };
+        static const std::size_t ALL_BUCKETS{ std::size_t{ 1 } << SoundexCode::BITS };
+
+        using Histogram = std::array<std::size_t, PASS_BUCKETS>;
+
+        inline auto Digit(SoundexCode code, std::size_t pass) -> std::size_t
+        {
+            return (std::size_t{ code.Packed() } >> (pass * PASS_BITS)) & (PASS_BUCKETS - 1);
+        }
+
+        // Least significant digit first, two passes of 7 bits, ping-ponging between
+        // the input and a scratch copy. Both histograms are gathered in one read.
+        template <typename T>
+        auto StableSort(std::vector<T>& items, std::vector<SoundexCode>& codes) -> void
+        {
+            auto histograms = std::array<Histogram, 2>{};
+            for (const auto code : codes)
+            {
+                ++histograms[0][Digit(code, 0)];
+                ++histograms[1][Digit(code, 1)];
+            }
+
+            auto scratch_items = std::vector<T>(std::size(items));
+            auto scratch_codes = std::vector<SoundexCode>(std::size(codes));
+            for (std::size_t pass = 0; pass < 2; ++pass)
+            {
+                auto offset = std::size_t{ 0 };
+                for (auto& count : histograms[pass])
+                    offset += std::exchange(count, offset);
+                for (std::size_t i = 0; i < std::size(codes); ++i)
+                {
+                    const auto destination = histograms[pass][Digit(codes[i], pass)]++;
+                    scratch_items[destination] = std::move(items[i]);
+                    scratch_codes[destination] = codes[i];
+                }
+                items.swap(scratch_items);
+                codes.swap(scratch_codes);
+            }
+        }
+
+        // Single in place pass over all 14 bits (American flag sort): every record
+        // is swapped directly into the bucket its code belongs to.
+        template <typename T>
+        auto UnstableSort(std::vector<T>& items, std::vector<SoundexCode>& codes) -> void
+        {
+            auto heads = std::vector<std::size_t>(ALL_BUCKETS + 1, 0);
+            for (const auto code : codes)
+                ++heads[code.Packed() + std::size_t{ 1 }];
+            for (std::size_t bucket = 1; bucket <= ALL_BUCKETS; ++bucket)
+                heads[bucket] += heads[bucket - 1];
+            auto tails = std::vector<std::size_t>(std::begin(heads) + 1, std::end(heads));
+
+            for (std::size_t bucket = 0; bucket < ALL_BUCKETS; ++bucket)
+            {
+                while (heads[bucket] < tails[bucket])
+                {
+                    auto& position = heads[bucket];
+                    const auto target = codes[position].Packed();
+                    if (target == bucket)
+                    {
+                        ++position;
+                        continue;
+                    }
+                    const auto destination = heads[target]++;
+                    std::swap(items[position], items[destination]);
+                    std::swap(codes[position], codes[destination]);
+                }
+            }
+        }
+    } // namespace Detail
+
+    // Sorts items by the code at the same position, permuting codes alongside.
+    template <typename T>
+    auto SortByCode(std::vector<T>& items, std::vector<SoundexCode>& codes, Order order = Order::Stable) -> void
+    {
+        if (std::size(items) != std::size(codes))
+            throw std::invalid_argument("Items and codes must have the same length");
+        if (order == Order::Stable)
+            Detail::StableSort(items, codes);
+        else
+            Detail::UnstableSort(items, codes);
+    }
+
+    // Stable sort where each thread histograms and scatters its own contiguous chunk.
+    // Within a bucket, chunk t writes after chunks 0..t-1, which keeps the input order.
+    template <typename T>
+    auto ParallelSortByCode(std::vector<T>& items, std::vector<SoundexCode>& codes, std::size_t thread_count) -> void
+    {
+        if (std::size(items) != std::size(codes))
+            throw std::invalid_argument("Items and codes must have the same length");
+        const auto size = std::size(codes);
+        thread_count = std::max<std::size_t>(1, std::min(Parallel::ThreadCount(thread_count), size));
+
+        auto histograms = std::vector<Detail::Histogram>(thread_count);
+        auto scratch_items = std::vector<T>(size);
+        auto scratch_codes = std::vector<SoundexCode>(size);
+        for (std::size_t pass = 0; pass < 2; ++pass)
+        {
+            Parallel::ForEachChunk(size, thread_count,
+                                   [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                                   {
+                                       auto& histogram = histograms[chunk];
+                                       histogram.fill(0);
+                                       for (auto i = begin; i < end; ++i)
+                                           ++histogram[Detail::Digit(codes[i], pass)];
+                                   });
+
+            auto offset = std::size_t{ 0 };
+            for (std::size_t bucket = 0; bucket < Detail::PASS_BUCKETS; ++bucket)
+                for (auto& histogram : histograms)
+                    offset += std::exchange(histogram[bucket], offset);
+
+            Parallel::ForEachChunk(size, thread_count,
+                                   [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                                   {
+                                       auto& offsets = histograms[chunk];
+                                       for (auto i = begin; i < end; ++i)
+                                       {
+                                           const auto destination = offsets[Detail::Digit(codes[i], pass)]++;
+                                           scratch_items[destination] = std::move(items[i]);
+                                           scratch_codes[destination] = codes[i];
+                                       }
+                                   });
+            items.swap(scratch_items);
+            codes.swap(scratch_codes);
+        }
+    }
+
+    // Returns record ids 0..n-1 ordered by codes[id].
+    inline auto SortedIdsByCode(const std::vector<SoundexCode>& codes, Order order = Order::Stable)
+        -> std::vector<std::uint32_t>
+    {
+        auto ids = std::vector<std::uint32_t>(std::size(codes));
+        for (std::size_t i = 0; i < std::size(ids); ++i)
+            ids[i] = static_cast<std::uint32_t>(i);
+        auto keys = codes;
+        SortByCode(ids, keys, order);
+        return ids;
+    }
+
+    // Encodes every name once and sorts the views by their code.
+    // Throws, like Soundex::Encode, if any name cannot be encoded.
+    inline auto SortNamesByCode(std::vector<std::string_view>& names, std::size_t thread_count = 1) -> void
+    {
+        auto codes = std::vector<SoundexCode>(std::size(names));
+        Parallel::ForEachChunk(std::size(names), thread_count,
+                               [&](std::size_t, std::size_t begin, std::size_t end)
+                               {
+                                   for (auto i = begin; i < end; ++i)
+                                       codes[i] = Soundex::EncodePacked(names[i]);
+                               });
+        if (thread_count == 1)
+            SortByCode(names, codes);
+        else
+            ParallelSortByCode(names, codes, thread_count);
+    }
+} // namespace RadixSort
@@ -0,0 +1,293 @@
+//
+// Record linkage between two CSV files, blocked on phonetic codes.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "csv.hpp"
+#include "jaro_winkler.hpp"
+#include "parallel.hpp"
+#include "phonetic_encoder.hpp"
+#include "soundex.hpp"
+
+// The left file is loaded and grouped into blocks by a composite key: the phonetic
+// code of the surname (Soundex unless another encoder is given) plus the first
+// letters of the given name. A surname with several codes, as Daitch–Mokotoff and
+// Double Metaphone give, puts its record in the block of each. The right file is
+// streamed in batches; every right record is compared, on each compare column, with
+// the left records of its blocks, once each, and pairs scoring at least the threshold
+// are written as "left_row,right_row,score". Rows are numbered from 0, headers excluded.
+namespace RecordLinkage
+{
+    struct Options
+    {
+        std::size_t surname_column{ 0 };
+        // Column whose leading letters extend the blocking key, if any
+        std::optional<std::size_t> given_name_column{ 1 };
+        std::size_t initials{ 1 }; // How many leading letters, see MaxInitials
+        // Columns scored with Jaro-Winkler; the pair score is their mean
+        std::vector<std::size_t> compare_columns{ 0, 1 };
+        double threshold{ 0.85 };
+        bool has_header{ true };
+        std::size_t thread_count{ 0 }; // 0 is one per hardware thread
+        std::size_t batch_size{ 16384 }; // Right records scored together
+    };
+
+    struct Stats
+    {
+        std::uint64_t left_records{ 0 };
+        std::uint64_t right_records{ 0 };
+        std::uint64_t rejected{ 0 }; // Rows whose surname cannot be encoded, on both sides
+        std::uint64_t candidate_pairs{ 0 };
+        std::uint64_t matches{ 0 };
+    };
+
+    // Most initials that fit the 64-bit blocking key next to a code of Encoder, at most 8
+    template <typename Encoder = Soundex>
+    constexpr auto MaxInitials() -> std::size_t
+    {
+        return std::min<std::size_t>(8, (64 - Encoder::Code::BITS) / 5);
+    }
+
+    namespace Detail
+    {
+        inline auto Field(const std::vector<std::string>& fields, std::size_t column) -> std::string_view
+        {
+            return column < std::size(fields) ? std::string_view{ fields[column] } : std::string_view{};
+        }
+
+        // Code in the high bits, then 5 bits per initial (0 when the given name is shorter)
+        inline auto WithInitials(std::uint64_t code, const std::vector<std::string>& fields, const Options& options)
+            -> std::uint64_t
+        {
+            auto key = code;
+            if (!options.given_name_column.has_value())
+                return key;
+            const auto given_name = Field(fields, *options.given_name_column);
+            for (std::size_t i = 0; i < options.initials; ++i)
+            {
+                auto letter = std::uint64_t{ 0 };
+                if (i < std::size(given_name) && std::isalpha(static_cast<unsigned char>(given_name[i])))
+                    letter = static_cast<std::uint64_t>(std::tolower(static_cast<unsigned char>(given_name[i])) - 'a' + 1);
+                key = (key << 5) | letter;
+            }
+            return key;
+        }
+
+        // Writes the blocking keys of a record, one per code of its surname, and returns
+        // how many; 0 if the surname cannot be encoded
+        template <typename Encoder>
+        auto BlockingKeys(const std::vector<std::string>& fields, const Options& options,
+                          std::array<std::uint64_t, Encoder::MAX_CODES>& keys) -> std::size_t
+        {
+            auto codes = std::array<typename Encoder::Code, Encoder::MAX_CODES>{};
+            const auto count = Encoder::EncodeAll(Field(fields, options.surname_column), std::data(codes));
+            for (std::size_t i = 0; i < count; ++i)
+                keys[i] = WithInitials(std::uint64_t{ codes[i].Packed() }, fields, options);
+            return count;
+        }
+
+        inline auto FormatMatch(std::string& output, std::uint64_t left_row, std::uint64_t right_row, double score)
+            -> void
+        {
+            char buffer[64];
+            const auto size = std::snprintf(buffer, sizeof(buffer), "%llu,%llu,%.4f\n",
+                                            static_cast<unsigned long long>(left_row),
+                                            static_cast<unsigned long long>(right_row), score);
+            output.append(buffer, static_cast<std::size_t>(size));
+        }
+
+        // Left records, with only their compare fields kept, grouped by blocking key
+        template <typename Encoder>
+        class BlockIndex
+        {
+        public:
+            BlockIndex(std::istream& left_csv, const Options& options, Stats& stats)
+                : column_count_{ std::size(options.compare_columns) }
+            {
+                auto reader = Csv::Reader{ left_csv };
+                auto fields = std::vector<std::string>{};
+                if (options.has_header)
+                    reader.ReadRow(fields);
+                auto keyed = std::vector<std::pair<std::uint64_t, std::uint64_t>>{}; // Key, left record
+                auto keys = std::array<std::uint64_t, Encoder::MAX_CODES>{};
+                for (auto row = std::uint64_t{ 0 }; reader.ReadRow(fields); ++row)
+                {
+                    const auto key_count = BlockingKeys<Encoder>(fields, options, keys);
+                    if (key_count == 0)
+                    {
+                        ++stats.rejected;
+                        continue;
+                    }
+                    for (std::size_t k = 0; k < key_count; ++k)
+                        keyed.emplace_back(keys[k], std::size(rows_));
+                    rows_.push_back(row);
+                    for (const auto column : options.compare_columns)
+                    {
+                        text_.append(Field(fields, column));
+                        ends_.push_back(std::size(text_));
+                    }
+                }
+                stats.left_records = std::size(rows_);
+
+                std::sort(std::begin(keyed), std::end(keyed));
+                order_.reserve(std::size(keyed));
+                for (std::size_t i = 0; i < std::size(keyed); ++i)
+                {
+                    if (i == 0 || keyed[i].first != keyed[i - 1].first)
+                        blocks_[keyed[i].first] = { i, 0 };
+                    ++blocks_[keyed[i].first].second;
+                    order_.push_back(keyed[i].second);
+                }
+            }
+
+            // Calls fn(record) for every left record in the block of key
+            template <typename Fn>
+            auto ForEachInBlock(std::uint64_t key, Fn fn) const -> void
+            {
+                const auto block = blocks_.find(key);
+                if (block == std::end(blocks_))
+                    return;
+                const auto [begin, count] = block->second;
+                for (auto i = begin; i < begin + count; ++i)
+                    fn(order_[i]);
+            }
+
+            auto Row(std::uint64_t record) const -> std::uint64_t
+            {
+                return rows_[record];
+            }
+
+            auto CompareField(std::uint64_t record, std::size_t column) const -> std::string_view
+            {
+                const auto index = record * column_count_ + column;
+                const auto begin = index == 0 ? 0 : ends_[index - 1];
+                return std::string_view{ text_ }.substr(begin, ends_[index] - begin);
+            }
+
+        private:
+            std::size_t column_count_;
+            std::vector<std::uint64_t> rows_; // Row number of each record
+            std::string text_;                // Compare fields of every record, back to back
+            std::vector<std::size_t> ends_;
+            std::vector<std::uint64_t> order_; // Records sorted by key
+            std::unordered_map<std::uint64_t, std::pair<std::size_t, std::size_t>> blocks_;
+        };
+    } // namespace Detail
+
+    template <typename Encoder = Soundex>
+    auto Link(std::istream& left_csv, std::istream& right_csv, std::ostream& output, const Options& options = {})
+        -> Stats
+    {
+        static_assert(PhoneticEncoder::IS_ENCODER<Encoder>, "Not a phonetic encoder");
+        if (options.initials > MaxInitials<Encoder>())
+            throw std::invalid_argument("At most " + std::to_string(MaxInitials<Encoder>()) +
+                                        " initials can be part of the blocking key");
+
+        auto stats = Stats{};
+        const auto index = Detail::BlockIndex<Encoder>{ left_csv, options, stats };
+        const auto thread_count = Parallel::ThreadCount(options.thread_count);
+        const auto column_count = std::size(options.compare_columns);
+        output << "left_row,right_row,score\n";
+
+        auto reader = Csv::Reader{ right_csv };
+        auto batch = std::vector<std::vector<std::string>>(options.batch_size);
+        auto chunk_outputs = std::vector<std::string>(thread_count);
+        auto chunk_stats = std::vector<Stats>(thread_count);
+        auto header = std::vector<std::string>{};
+        if (options.has_header)
+            reader.ReadRow(header);
+
+        auto first_row = std::uint64_t{ 0 };
+        for (auto batch_size = std::size_t{ 0 };; first_row += batch_size)
+        {
+            batch_size = 0;
+            while (batch_size < options.batch_size && reader.ReadRow(batch[batch_size]))
+                ++batch_size;
+            if (batch_size == 0)
+                break;
+
+            for (auto& chunk_output : chunk_outputs)
+                chunk_output.clear();
+            Parallel::ForEachChunk(
+                batch_size, thread_count,
+                [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                {
+                    auto& chunk_output = chunk_outputs[chunk];
+                    auto& chunk_stat = chunk_stats[chunk];
+                    auto patterns = std::vector<JaroWinkler::Pattern>(column_count);
+                    auto keys = std::array<std::uint64_t, Encoder::MAX_CODES>{};
+                    auto candidates = std::vector<std::uint64_t>{};
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        const auto& fields = batch[i];
+                        const auto key_count = Detail::BlockingKeys<Encoder>(fields, options, keys);
+                        if (key_count == 0)
+                        {
+                            ++chunk_stat.rejected;
+                            continue;
+                        }
+                        ++chunk_stat.right_records;
+                        // The right record is prepared once and scored against its whole block
+                        for (std::size_t c = 0; c < column_count; ++c)
+                            patterns[c].Assign(Detail::Field(fields, options.compare_columns[c]));
+                        const auto score_pair = [&](std::uint64_t record)
+                        {
+                            auto score = 0.0;
+                            for (std::size_t c = 0; c < column_count; ++c)
+                                score += patterns[c].Similarity(index.CompareField(record, c));
+                            score = column_count == 0 ? 1.0 : score / static_cast<double>(column_count);
+                            ++chunk_stat.candidate_pairs;
+                            if (score < options.threshold)
+                                return;
+                            ++chunk_stat.matches;
+                            Detail::FormatMatch(chunk_output, index.Row(record), first_row + i, score);
+                        };
+                        if (key_count == 1)
+                        {
+                            index.ForEachInBlock(keys[0], score_pair);
+                            continue;
+                        }
+                        // A left record sharing several codes with this one is scored once
+                        candidates.clear();
+                        for (std::size_t k = 0; k < key_count; ++k)
+                            index.ForEachInBlock(keys[k], [&candidates](std::uint64_t record)
+                                                 { candidates.push_back(record); });
+                        std::sort(std::begin(candidates), std::end(candidates));
+                        candidates.erase(std::unique(std::begin(candidates), std::end(candidates)),
+                                         std::end(candidates));
+                        for (const auto record : candidates)
+                            score_pair(record);
+                    }
+                });
+            for (const auto& chunk_output : chunk_outputs)
+                output.write(std::data(chunk_output), static_cast<std::streamsize>(std::size(chunk_output)));
+            if (!output)
+                throw std::runtime_error("Cannot write linkage output");
+        }
+
+        for (const auto& chunk_stat : chunk_stats)
+        {
+            stats.right_records += chunk_stat.right_records;
+            stats.rejected += chunk_stat.rejected;
+            stats.candidate_pairs += chunk_stat.candidate_pairs;
+            stats.matches += chunk_stat.matches;
+        }
+        return stats;
+    }
+} // namespace RecordLinkage
@@ -0,0 +1,82 @@
+//
+// Refined Soundex, a finer grained variant of Soundex with ten digit classes.
+//
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "packed_code.hpp"
+
+struct RefinedSoundexAlphabet
+{
+    static constexpr std::string_view SYMBOLS{ "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ" };
+};
+
+// A Refined Soundex code such as "B1905": the first letter then one digit per
+// sound, 6 bits per character. Codes are cut to eight characters.
+using RefinedSoundexCode = BasicPackedCode<RefinedSoundexAlphabet, 8>;
+
+// Refined Soundex as in the Apache Commons Codec: the first letter, then the digit
+// of every letter including the first, vowels too, skipping a digit equal to the
+// previous one. Unlike Soundex the code has no fixed length and is not padded.
+class RefinedSoundex
+{
+public:
+    using Code = RefinedSoundexCode;
+
+    static constexpr std::size_t MAX_CODES{ 1 };
+
+    // Returns false, leaving code untouched, if word is not allowed (empty or not
+    // only ASCII letters)
+    static auto EncodeInto(std::string_view word, Code& code) -> bool
+    {
+        if (word.empty())
+            return false;
+        for (const auto letter : word)
+            if (Digit(letter) == NOT_A_LETTER)
+                return false;
+
+        auto encoded = Code{};
+        encoded.Append(static_cast<char>(word.front() & 0xDF));
+        auto last = NOT_A_LETTER;
+        for (std::size_t i = 0; i < std::size(word) && encoded.Size() < Code::SIZE; ++i)
+        {
+            const auto digit = Digit(word[i]);
+            if (digit != last)
+                encoded.Append(digit);
+            last = digit;
+        }
+        code = encoded;
+        return true;
+    }
+
+    static auto EncodeAll(std::string_view word, Code* codes) -> std::size_t
+    {
+        return EncodeInto(word, *codes) ? 1 : 0;
+    }
+
+    // Throws if word is not allowed
+    static auto Encode(const std::string& word) -> std::string
+    {
+        auto code = Code{};
+        if (!EncodeInto(word, code))
+            throw std::runtime_error("Invalid input: " + word);
+        return code.ToString();
+    }
+
+private:
+    static constexpr char NOT_A_LETTER{ '\0' };
+    // Digits of 'A' to 'Z'
+    static constexpr std::string_view DIGITS{ "01360240043788015936020505" };
+
+    static auto Digit(char letter) -> char
+    {
+        const auto upper = letter & 0xDF;
+        if (upper < 'A' || upper > 'Z')
+            return NOT_A_LETTER;
+        return DIGITS[static_cast<std::size_t>(upper - 'A')];
+    }
+};
@@ -5,32 +5,193 @@
 //
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 
 #include "helpers.hpp"
+#include "soundex_code.hpp"
+#include "soundex_rules.hpp"
+#include "unicode.hpp"
 
-class Soundex
+// Soundex codes of N characters: the first letter, then N - 1 digits.
+// The code length is a template parameter so that the packed fast path below gets
+// its loop bounds, padding and output width fixed at compile time, and the dialect
+// (see soundex_rules.hpp) is one so that its tables are built at compile time too.
+template <std::size_t N, typename Rules = SoundexRules::Legacy>
+class BasicSoundex
 {
-    static const std::size_t FIXED_SIZE{ 4 };
+    using Machine = SoundexRules::Machine<Rules>;
+
+    static constexpr std::size_t FIXED_SIZE{ N };
 
 public:
+    using Code = BasicSoundexCode<N>;
+
     static auto Encode(const std::string& word) -> std::string
     {
+        if constexpr (std::is_same_v<Rules, SoundexRules::Legacy>)
+            return EncodeExtended(word, FIXED_SIZE);
+        else
+            return EncodePacked(word).ToString();
+    }
+
+    // Longer codes carry on with the same rules, so Encode(word) is always a prefix
+    // of EncodeExtended(word, size). Only available with the original rules.
+    static auto EncodeExtended(const std::string& word, std::size_t size) -> std::string
+    {
+        static_assert(std::is_same_v<Rules, SoundexRules::Legacy>, "Use a longer code length instead");
+        if (size < FIXED_SIZE)
+            throw std::invalid_argument("Soundex codes have at least " + std::to_string(N) + " characters");
+        if (!Unicode::IsAscii(word))
+        {
+            // Accented Latin letters are encoded as their base letters, Greek and
+            // Cyrillic ones as their transliterations
+            const auto folded = Unicode::FoldToAscii(word);
+            if (!folded.has_value())
+                throw std::runtime_error("Input is not allowed. When input: " + word);
+            return EncodeExtended(*folded, size);
+        }
         if (!SanitizeInput(word))
             throw std::runtime_error("Input is not allowed. When input: " + word);
-        const auto encoding = [&word]
+        // The first letter takes the place of its digit
+        auto encoding = EncodeDigits(word, size);
+        encoding.front() = Helpers::ToUppercase(Helpers::Head(word).front());
+        Helpers::PadWithZeros(encoding, size);
+        return encoding;
+    }
+
+    // Same as Encode, but packed for sorting and indexing.
+    static auto EncodePacked(std::string_view word) -> Code
+    {
+        auto code = Code{};
+        if (!EncodeInto(word, code))
+            throw std::runtime_error("Input is not allowed. When input: " + std::string{ word });
+        return code;
+    }
+
+    // Same as EncodePacked, but returns std::nullopt instead of throwing on invalid input.
+    static auto TryEncodePacked(std::string_view word) -> std::optional<Code>
+    {
+        return TryEncodePacked<char>(word);
+    }
+
+    template <typename CharT>
+    static auto TryEncodePacked(Unicode::Text<CharT> word) -> std::optional<Code>
+    {
+        auto code = Code{};
+        if (!EncodeInto(word, code))
+            return std::nullopt;
+        return code;
+    }
+
+    // Multi-code form shared with DaitchMokotoff, used by BatchEncode and CodeIndex:
+    // writes the codes of word and returns how many, 0 if word is not allowed.
+    // A word has one Soundex code.
+    static constexpr std::size_t MAX_CODES{ 1 };
+
+    static auto EncodeAll(std::string_view word, Code* codes) -> std::size_t
+    {
+        return EncodeAll<char>(word, codes);
+    }
+
+    template <typename CharT>
+    static auto EncodeAll(Unicode::Text<CharT> word, Code* codes) -> std::size_t
+    {
+        return EncodeInto(word, *codes) ? 1 : 0;
+    }
+
+    // Encodes straight into the packed code, running the rules' state machine with
+    // two table lookups per letter and no allocation. Returns false, leaving code
+    // untouched, if word is not allowed.
+    //
+    // word is Unicode text of any character type (see unicode.hpp), read in place.
+    // Pure ASCII words, checked with SIMD, are read code unit by code unit; others
+    // are decoded and transliterated to ASCII letters on the fly.
+    static auto EncodeInto(std::string_view word, Code& code) -> bool
+    {
+        return EncodeInto<char>(word, code);
+    }
+
+    template <typename CharT>
+    static auto EncodeInto(Unicode::Text<CharT> word, Code& code) -> bool
+    {
+        if (Unicode::IsAscii(word))
+            return EncodeLetters(AsciiLetters<CharT>{ word }, code);
+        return EncodeLetters(Unicode::Letters<CharT>{ word }, code);
+    }
+
+    // Code units of an ASCII word, in the interface of Unicode::Letters
+    template <typename CharT>
+    class AsciiLetters
+    {
+    public:
+        explicit AsciiLetters(Unicode::Text<CharT> word) : word_{ word }
+        {
+        }
+
+        auto Next() -> int
+        {
+            if (position_ == std::size(word_))
+                return Unicode::END;
+            return static_cast<int>(word_[position_++]);
+        }
+
+    private:
+        Unicode::Text<CharT> word_;
+        std::size_t position_{ 0 };
+    };
+
+    // EncodeInto over letters from any source with the Next() of Unicode::Letters;
+    // MultiKey passes one that also keeps the letters for Double Metaphone.
+    template <typename Letters>
+    static auto EncodeLetters(Letters letters, Code& code) -> bool
+    {
+        using Storage = typename Code::Storage;
+        const auto first_letter = letters.Next();
+        if (first_letter == Unicode::END)
+            return false;
+        const auto first = Machine::CLASSES[static_cast<std::size_t>(first_letter)];
+        if (first == Machine::NOT_A_LETTER)
+            return false;
+
+        // Uppercase ASCII letter, then the digits shifted in below it
+        auto packed = static_cast<Storage>((static_cast<unsigned>(first_letter) & 0xDFu) - 'A');
+        auto state = Machine::InitialState(first);
+        auto digits = std::size_t{ 0 };
+        auto letter = letters.Next();
+        for (; letter != Unicode::END && digits < FIXED_SIZE - 1; letter = letters.Next())
         {
-            auto first_letter = Helpers::ToUppercase(Helpers::Head(word));
-            auto tail_encoding = Helpers::Tail(EncodeDigits(word));
-            return first_letter + tail_encoding;
-        }();
-        return Helpers::PadWithZeros(encoding, FIXED_SIZE);
+            const auto letter_class = Machine::CLASSES[static_cast<std::size_t>(letter)];
+            if (letter_class == Machine::NOT_A_LETTER)
+                return false;
+            const auto digit = Machine::Step(state, letter_class);
+            if (digit != 0)
+            {
+                packed = static_cast<Storage>((packed << 3) | digit);
+                ++digits;
+            }
+        }
+        // The rest of the word is not encoded, but must still be letters
+        for (; letter != Unicode::END; letter = letters.Next())
+            if (Machine::CLASSES[static_cast<std::size_t>(letter)] == Machine::NOT_A_LETTER)
+                return false;
+
+        // Zero padding
+        code = Code::FromPacked(static_cast<Storage>(packed << (3 * (FIXED_SIZE - 1 - digits))));
+        return true;
     }
 
 private:
     // Returns true if input is OK, false otherwise.
-    static auto SanitizeInput(const std::string& word) -> bool
+    static auto SanitizeInput(std::string_view word) -> bool
     {
         if (std::size(word) == 0)
             return false;
@@ -43,9 +204,10 @@ private:
                            });
     }
 
-    static auto EncodeDigits(const std::string& word) -> std::string
+    static auto EncodeDigits(std::string_view word, std::size_t size) -> std::string
     {
         auto digits = std::string{};
+        digits.reserve(size);
         // We need to check on the first digit's code, in order to avoid duplication
         const auto first_code = EncodeDigit(word.front());
         digits.push_back(first_code.value_or('*'));
@@ -72,7 +234,7 @@ private:
                 }
             }
             last_letter = letter;
-            if (encoded_consonants + 1 == FIXED_SIZE) // We already have the first letter "as is"
+            if (encoded_consonants + 1 == size) // We already have the first letter "as is"
                 break;
         }
         return digits;
@@ -100,3 +262,5 @@ private:
         return item->second;
     }
 };
+
+using Soundex = BasicSoundex<4>;
@@ -0,0 +1,132 @@
+//
+// Packed representation of a Soundex code.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// A Soundex code of N characters such as "R163" packed into an integer: the first
+// letter takes the high 5 bits and each digit ('0' to '6') takes 3 bits below it,
+// so the four character code fits in 14 bits. The storage is the smallest unsigned
+// type that holds 5 + 3 * (N - 1) bits. Comparing packed values orders codes exactly
+// like comparing their strings.
+template <std::size_t N>
+class BasicSoundexCode
+{
+    static_assert(N >= 2 && N <= 20, "Soundex codes have between 2 and 20 characters");
+
+    static constexpr std::size_t DIGIT_BITS{ 3 };
+    static constexpr std::size_t DIGIT_COUNT{ N - 1 };
+    static constexpr std::size_t DIGIT_VALUES{ 7 };
+
+    static constexpr auto PowerOfDigitValues(std::size_t exponent) -> std::size_t
+    {
+        return exponent == 0 ? 1 : DIGIT_VALUES * PowerOfDigitValues(exponent - 1);
+    }
+
+public:
+    static constexpr std::size_t SIZE{ N };
+    static constexpr std::size_t BITS{ 5 + DIGIT_BITS * DIGIT_COUNT };
+    // Number of distinct codes, "A000" to "Z666" for N = 4
+    static constexpr std::size_t RANK_COUNT{ 26 * PowerOfDigitValues(DIGIT_COUNT) };
+
+    using Storage = std::conditional_t<BITS <= 16, std::uint16_t,
+                                       std::conditional_t<BITS <= 32, std::uint32_t, std::uint64_t>>;
+
+    BasicSoundexCode() = default;
+
+    static auto FromPacked(Storage packed) -> BasicSoundexCode
+    {
+        return BasicSoundexCode{ packed };
+    }
+
+    static auto FromString(std::string_view code) -> BasicSoundexCode
+    {
+        if (std::size(code) != N || code.front() < 'A' || code.front() > 'Z')
+            throw std::runtime_error("Not a Soundex code: " + std::string{ code });
+        auto packed = static_cast<Storage>(code.front() - 'A');
+        for (std::size_t i = 1; i < N; ++i)
+        {
+            if (code[i] < '0' || code[i] > '6')
+                throw std::runtime_error("Not a Soundex code: " + std::string{ code });
+            packed = static_cast<Storage>((packed << DIGIT_BITS) | static_cast<Storage>(code[i] - '0'));
+        }
+        return BasicSoundexCode{ packed };
+    }
+
+    auto Packed() const -> Storage
+    {
+        return packed_;
+    }
+
+    // Dense index in [0, RANK_COUNT), preserving code order
+    auto Rank() const -> std::size_t
+    {
+        const auto packed = std::size_t{ packed_ };
+        auto rank = packed >> (DIGIT_BITS * DIGIT_COUNT);
+        for (std::size_t i = DIGIT_COUNT; i-- > 0;)
+            rank = rank * DIGIT_VALUES + ((packed >> (DIGIT_BITS * i)) & 0x7u);
+        return rank;
+    }
+
+    static auto FromRank(std::size_t rank) -> BasicSoundexCode
+    {
+        auto packed = std::size_t{ 0 };
+        for (std::size_t i = 0; i < DIGIT_COUNT; ++i)
+        {
+            packed |= (rank % DIGIT_VALUES) << (DIGIT_BITS * i);
+            rank /= DIGIT_VALUES;
+        }
+        return BasicSoundexCode{ static_cast<Storage>(packed | (rank << (DIGIT_BITS * DIGIT_COUNT))) };
+    }
+
+    // Code of the first M characters. Soundex codes of different lengths follow the
+    // same rules, so this is the code a BasicSoundex<M> gives for the same word.
+    template <std::size_t M>
+    auto Prefix() const -> BasicSoundexCode<M>
+    {
+        static_assert(M <= N, "A prefix cannot be longer than the code");
+        using PrefixStorage = typename BasicSoundexCode<M>::Storage;
+        return BasicSoundexCode<M>::FromPacked(
+            static_cast<PrefixStorage>(std::size_t{ packed_ } >> (DIGIT_BITS * (N - M))));
+    }
+
+    auto ToString() const -> std::string
+    {
+        const auto packed = std::size_t{ packed_ };
+        auto code = std::string(N, '0');
+        code.front() = static_cast<char>('A' + (packed >> (DIGIT_BITS * DIGIT_COUNT)));
+        for (std::size_t i = 0; i < DIGIT_COUNT; ++i)
+            code[DIGIT_COUNT - i] = static_cast<char>('0' + ((packed >> (DIGIT_BITS * i)) & 0x7u));
+        return code;
+    }
+
+    friend auto operator==(BasicSoundexCode lhs, BasicSoundexCode rhs) -> bool
+    {
+        return lhs.packed_ == rhs.packed_;
+    }
+
+    friend auto operator!=(BasicSoundexCode lhs, BasicSoundexCode rhs) -> bool
+    {
+        return lhs.packed_ != rhs.packed_;
+    }
+
+    friend auto operator<(BasicSoundexCode lhs, BasicSoundexCode rhs) -> bool
+    {
+        return lhs.packed_ < rhs.packed_;
+    }
+
+private:
+    explicit BasicSoundexCode(Storage packed) : packed_{ packed }
+    {
+    }
+
+    Storage packed_{ 0 };
+};
+
+using SoundexCode = BasicSoundexCode<4>;
@@ -0,0 +1,155 @@
+//
+// Compile-time rule sets (dialects) for BasicSoundex.
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Systems disagree on a few Soundex details: whether 'h', 'w' and 'y' let a repeated
+// digit be coded again, and whether the first letter's digit suppresses the same
+// digit right after it. A rule set states those choices as constants, and Machine
+// turns them into the lookup tables the encoder runs on, all at compile time.
+namespace SoundexRules
+{
+    // What a letter without a digit does to two equal digits around it
+    enum class Role
+    {
+        Separator,   // Like a vowel: the second digit is coded again
+        Transparent, // Ignored: the digits merge, and a vowel before it still separates
+        Blocking     // The digits merge, and a vowel right before it no longer separates
+    };
+
+    // This repository's original rules: only a vowel directly before a letter separates it
+    // from an equal digit, and 'h', 'w' and 'y' block.
+    struct Legacy
+    {
+        static constexpr Role H{ Role::Blocking };
+        static constexpr Role W{ Role::Blocking };
+        static constexpr Role Y{ Role::Blocking };
+        static constexpr bool FIRST_LETTER_SUPPRESSES_DUPLICATE{ true };
+    };
+
+    // American Soundex as used by the US National Archives
+    struct American
+    {
+        static constexpr Role H{ Role::Transparent };
+        static constexpr Role W{ Role::Transparent };
+        static constexpr Role Y{ Role::Separator };
+        static constexpr bool FIRST_LETTER_SUPPRESSES_DUPLICATE{ true };
+    };
+
+    // Every uncoded letter separates, as in many database SOUNDEX functions
+    struct Simplified
+    {
+        static constexpr Role H{ Role::Separator };
+        static constexpr Role W{ Role::Separator };
+        static constexpr Role Y{ Role::Separator };
+        static constexpr bool FIRST_LETTER_SUPPRESSES_DUPLICATE{ true };
+    };
+
+    // The encoder's state machine for a rule set.
+    //
+    // Every byte maps to a class: a digit 1 to 6, or the role of an uncoded letter.
+    // The state is the last coded digit plus whether a separator followed it, and
+    // TRANSITIONS gives, for a state and a class, the next state and the digit to
+    // emit, if any, so encoding a letter is two table lookups.
+    template <typename Rules>
+    class Machine
+    {
+        static constexpr std::uint8_t SEPARATOR{ 0 };
+        static constexpr std::uint8_t TRANSPARENT{ 7 };
+        static constexpr std::uint8_t BLOCKING{ 8 };
+        static constexpr std::size_t CLASS_COUNT{ 9 };
+        static constexpr std::size_t STATE_COUNT{ 7 * 2 };
+
+        static constexpr auto ClassOf(Role role) -> std::uint8_t
+        {
+            return role == Role::Separator ? SEPARATOR : role == Role::Transparent ? TRANSPARENT : BLOCKING;
+        }
+
+        static constexpr auto MakeClasses() -> std::array<std::uint8_t, 256>
+        {
+            auto classes = std::array<std::uint8_t, 256>{};
+            for (auto& letter_class : classes)
+                letter_class = NOT_A_LETTER;
+            const auto set = [&classes](const char* letters, std::uint8_t letter_class)
+            {
+                for (; *letters != '\0'; ++letters)
+                {
+                    classes[static_cast<unsigned char>(*letters)] = letter_class;
+                    classes[static_cast<unsigned char>(*letters - 'a' + 'A')] = letter_class;
+                }
+            };
+            set("aeiou", SEPARATOR);
+            set("h", ClassOf(Rules::H));
+            set("w", ClassOf(Rules::W));
+            set("y", ClassOf(Rules::Y));
+            set("bfpv", 1);
+            set("cgjkqsxz", 2);
+            set("dt", 3);
+            set("l", 4);
+            set("mn", 5);
+            set("r", 6);
+            return classes;
+        }
+
+        static constexpr auto State(std::size_t last_digit, bool after_separator) -> std::uint8_t
+        {
+            return static_cast<std::uint8_t>(last_digit * 2 + (after_separator ? 1 : 0));
+        }
+
+        static constexpr auto Transition(std::size_t next_state, std::size_t emitted) -> std::uint8_t
+        {
+            return static_cast<std::uint8_t>(next_state | (emitted << 4));
+        }
+
+        static constexpr auto MakeTransitions() -> std::array<std::uint8_t, STATE_COUNT * CLASS_COUNT>
+        {
+            auto transitions = std::array<std::uint8_t, STATE_COUNT * CLASS_COUNT>{};
+            for (std::size_t last = 0; last < 7; ++last)
+            {
+                for (std::size_t separated = 0; separated < 2; ++separated)
+                {
+                    const auto state = State(last, separated == 1);
+                    for (std::size_t letter_class = 0; letter_class < CLASS_COUNT; ++letter_class)
+                    {
+                        auto& transition = transitions[state * CLASS_COUNT + letter_class];
+                        if (letter_class == SEPARATOR)
+                            transition = Transition(State(last, true), 0);
+                        else if (letter_class == TRANSPARENT)
+                            transition = Transition(state, 0);
+                        else if (letter_class == BLOCKING)
+                            transition = Transition(State(last, false), 0);
+                        else if (letter_class != last || separated == 1)
+                            transition = Transition(State(letter_class, false), letter_class);
+                        else
+                            transition = Transition(State(last, false), 0);
+                    }
+                }
+            }
+            return transitions;
+        }
+
+    public:
+        static constexpr std::uint8_t NOT_A_LETTER{ 0xFF };
+        static constexpr std::array<std::uint8_t, 256> CLASSES{ MakeClasses() };
+        static constexpr std::array<std::uint8_t, STATE_COUNT * CLASS_COUNT> TRANSITIONS{ MakeTransitions() };
+
+        // State after the first letter, given its class
+        static constexpr auto InitialState(std::uint8_t first_class) -> std::uint8_t
+        {
+            const auto coded = first_class >= 1 && first_class <= 6;
+            return State(coded && Rules::FIRST_LETTER_SUPPRESSES_DUPLICATE ? first_class : 0, false);
+        }
+
+        // Feeds one letter class; returns the digit to emit, 0 for none
+        static auto Step(std::uint8_t& state, std::uint8_t letter_class) -> std::uint8_t
+        {
+            const auto transition = TRANSITIONS[state * CLASS_COUNT + letter_class];
+            state = transition & 0x0Fu;
+            return static_cast<std::uint8_t>(transition >> 4);
+        }
+    };
+} // namespace SoundexRules
@@ -0,0 +1,114 @@
+#include "catch.hpp"
+
+#include "../adaptive_index.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    auto Names(PhoneticIndex::Range range) -> std::vector<std::string_view>
+    {
+        auto names = std::vector<std::string_view>(range.begin(), range.end());
+        std::sort(std::begin(names), std::end(names));
+        return names;
+    }
+} // namespace
+
+TEST_CASE("Test extended Soundex codes", "[Soundex::EncodeExtended]")
+{
+    CHECK(Soundex::EncodeExtended("Ashcraft", 6) == "A26130");
+    CHECK(Soundex::EncodeExtended("Lee", 6) == "L00000");
+    CHECK(Soundex::EncodeExtended("Robert", 4) == Soundex::Encode("Robert"));
+    CHECK(Soundex::EncodeExtended("Washington", 8).substr(0, 4) == Soundex::Encode("Washington"));
+    CHECK_THROWS(Soundex::EncodeExtended("Robert", 3));
+}
+
+TEST_CASE("Test adaptive phonetic index", "[AdaptivePhoneticIndex]")
+{
+    // All S536 as four characters, told apart by the fifth and sixth ones
+    const auto names = std::vector<std::string_view>{ "Smithers",   "Smothers", "Smetherick", "Smatters", "Smithereen",
+                                                      "Smithrim",   "Smotherman", "Smithermann", "Smitherton",
+                                                      "Smithart",   "Smyther",  "Snider",     "Robert",   "Rupert",
+                                                      "4th" };
+    auto options = AdaptivePhoneticIndex::Options{};
+    options.max_bucket_size = 3;
+    options.max_code_size = 6;
+    const auto index = AdaptivePhoneticIndex{ names, options };
+
+    SECTION("Splits oversized buckets by the next digits")
+    {
+        CHECK(index.Size() == 14);
+        CHECK(index.Rejected() == 1);
+        CHECK(Names(index.Probe("Smithers")) ==
+              std::vector<std::string_view>{ "Smatters", "Smetherick", "Smithers", "Smothers" });
+        CHECK(Names(index.Probe("Smotherman")) == std::vector<std::string_view>{ "Smithermann", "Smotherman" });
+        CHECK(Names(index.Probe("Smithereen")) == std::vector<std::string_view>{ "Smithereen", "Smithrim" });
+        CHECK(Names(index.Probe("Snyder")) == std::vector<std::string_view>{ "Smyther", "Snider" });
+    }
+
+    SECTION("Leaves small buckets alone")
+    {
+        CHECK(Names(index.Probe("Rubert")) == std::vector<std::string_view>{ "Robert", "Rupert" });
+        CHECK(index.Probe("Zed").empty());
+        CHECK(index.Probe("R2").empty());
+    }
+
+    SECTION("Short codes find the whole original bucket")
+    {
+        CHECK(index.ProbeCode("S536").size() == 12);
+        CHECK(index.ProbeCode("S5365").size() == 4);
+        CHECK(Names(index.ProbeCode("S53655")) == std::vector<std::string_view>{ "Smithermann", "Smotherman" });
+        CHECK(index.ProbeCode("S5366").empty());
+    }
+
+    SECTION("Every name probes to a node holding it")
+    {
+        for (const auto name : names)
+        {
+            const auto found = index.Probe(name);
+            if (name == "4th")
+                continue;
+            CHECK(std::find(found.begin(), found.end(), name) != found.end());
+        }
+    }
+
+    SECTION("Probes with views of longer text")
+    {
+        const auto text = std::string_view{ "Smotherman,S536557,S536X" };
+        CHECK(Names(index.Probe(text.substr(0, 10))) == std::vector<std::string_view>{ "Smithermann", "Smotherman" });
+        CHECK(index.ProbeCode(text.substr(11, 6)).size() == 2);
+        CHECK_THROWS(index.ProbeCode(text.substr(19)));
+    }
+
+    SECTION("Extends codes up to 20 characters")
+    {
+        auto longest = options;
+        longest.max_bucket_size = 1;
+        longest.max_code_size = 20;
+        const auto longest_index = AdaptivePhoneticIndex{ names, longest };
+        for (const auto name : names)
+        {
+            if (name == "4th")
+                continue;
+            const auto found = longest_index.ProbeCode(Soundex::EncodeExtended(std::string{ name }, 20));
+            CHECK(std::find(found.begin(), found.end(), name) != found.end());
+            CHECK(longest_index.Probe(name).size() == found.size());
+        }
+
+        longest.max_code_size = 21;
+        CHECK_THROWS_AS(AdaptivePhoneticIndex(names, longest), std::invalid_argument);
+    }
+
+    SECTION("Bounds probes unless the longest codes collide")
+    {
+        // The four S53620 names cannot be told apart by six characters
+        CHECK(index.LargestProbe() == 4);
+        auto longer = options;
+        longer.max_code_size = 4;
+        CHECK(AdaptivePhoneticIndex{ names, longer }.LargestProbe() == 12);
+    }
+}
@@ -0,0 +1,325 @@
+#include "catch.hpp"
+
+#include "../batch_encode.hpp"
+#include "../code_index.hpp"
+#include "../daitch_mokotoff.hpp"
+#include "../double_metaphone.hpp"
+#include "../external_sort.hpp"
+#include "../multi_key.hpp"
+#include "../nysiis.hpp"
+#include "../phonetic_index.hpp"
+#include "../refined_soundex.hpp"
+#include "../soundex.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// This executable replaces the global operator new with one that counts calls and
+// live bytes, so the tests can check that the fast paths do not allocate and that
+// bounded algorithms stay within their bounds.
+namespace
+{
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> live_bytes{ 0 };
+    std::atomic<std::size_t> peak_bytes{ 0 };
+
+    // Every block starts with its size, keeping the memory after it aligned
+    constexpr std::size_t HEADER_SIZE{ alignof(std::max_align_t) };
+
+    // Allocations made by fn
+    template <typename Fn>
+    auto AllocationsOf(Fn fn) -> std::size_t
+    {
+        const auto before = allocations.load();
+        fn();
+        return allocations.load() - before;
+    }
+
+    // Most bytes allocated by fn and not yet freed at any point while it ran
+    template <typename Fn>
+    auto PeakBytesOf(Fn fn) -> std::size_t
+    {
+        const auto before = live_bytes.load();
+        peak_bytes.store(before);
+        fn();
+        return peak_bytes.load() - before;
+    }
+
+    auto Allocate(std::size_t size) noexcept -> void*
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        auto* block = static_cast<unsigned char*>(std::malloc(HEADER_SIZE + size));
+        if (block == nullptr)
+            return nullptr;
+        std::memcpy(block, &size, sizeof(size));
+        const auto live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        auto peak = peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+        return block + HEADER_SIZE;
+    }
+
+    // Discards what is written to it
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        auto overflow(int_type c) -> int_type override
+        {
+            return traits_type::not_eof(c);
+        }
+
+        auto xsputn(const char*, std::streamsize count) -> std::streamsize override
+        {
+            return count;
+        }
+    };
+
+    auto Names() -> std::vector<std::string_view>
+    {
+        return { "Ashcraft", "Tymczak", "Pfister", "Robert", "Rupert", "Washington", "Lee",
+                 "Gutierrez", "Jackson", "Honeyman", "Wolfeschlegelsteinhausenbergerdorff", "Not a name",
+                 "", "Müller", "Łukasz", "Иванов", "Παπαδόπουλος" };
+    }
+
+    template <typename Encoder>
+    auto EncodeAllOf(const std::vector<std::string_view>& names) -> std::size_t
+    {
+        auto codes = std::array<typename Encoder::Code, Encoder::MAX_CODES>{};
+        auto count = std::size_t{ 0 };
+        for (const auto name : names)
+            count += Encoder::EncodeAll(name, std::data(codes));
+        return count;
+    }
+} // namespace
+
+// Every replaceable form of operator new and delete, so that all memory comes from
+// malloc; [[gnu::noinline]] keeps the compiler from pairing malloc and free across them
+[[gnu::noinline]] auto operator new(std::size_t size) -> void*
+{
+    if (auto* memory = Allocate(size))
+        return memory;
+    throw std::bad_alloc{};
+}
+
+auto operator new[](std::size_t size) -> void*
+{
+    return operator new(size);
+}
+
+auto operator new(std::size_t size, const std::nothrow_t&) noexcept -> void*
+{
+    return Allocate(size);
+}
+
+auto operator new[](std::size_t size, const std::nothrow_t& nothrow) noexcept -> void*
+{
+    return operator new(size, nothrow);
+}
+
+[[gnu::noinline]] auto operator delete(void* memory) noexcept -> void
+{
+    if (memory == nullptr)
+        return;
+    auto* block = static_cast<unsigned char*>(memory) - HEADER_SIZE;
+    auto size = std::size_t{ 0 };
+    std::memcpy(&size, block, sizeof(size));
+    live_bytes.fetch_sub(size, std::memory_order_relaxed);
+    std::free(block);
+}
+
+auto operator delete[](void* memory) noexcept -> void
+{
+    operator delete(memory);
+}
+
+auto operator delete(void* memory, std::size_t) noexcept -> void
+{
+    operator delete(memory);
+}
+
+auto operator delete[](void* memory, std::size_t) noexcept -> void
+{
+    operator delete(memory);
+}
+
+auto operator delete(void* memory, const std::nothrow_t&) noexcept -> void
+{
+    operator delete(memory);
+}
+
+auto operator delete[](void* memory, const std::nothrow_t&) noexcept -> void
+{
+    operator delete(memory);
+}
+
+TEST_CASE("Test encoding does not allocate", "[Allocations]")
+{
+    const auto names = Names();
+
+    SECTION("Packed Soundex encoding")
+    {
+        auto code = SoundexCode{};
+        CHECK(AllocationsOf(
+                  [&]
+                  {
+                      for (const auto name : names)
+                          Soundex::EncodeInto(name, code);
+                  }) == 0);
+        CHECK(AllocationsOf([&] { Soundex::EncodeInto(std::u16string_view{ u"Müller" }, code); }) == 0);
+        auto long_code = BasicSoundexCode<8>{};
+        CHECK(AllocationsOf(
+                  [&]
+                  {
+                      for (const auto name : names)
+                          BasicSoundex<8>::EncodeInto(name, long_code);
+                  }) == 0);
+    }
+
+    SECTION("Every phonetic encoder")
+    {
+        CHECK(AllocationsOf([&] { EncodeAllOf<Soundex>(names); }) == 0);
+        CHECK(AllocationsOf([&] { EncodeAllOf<DaitchMokotoff>(names); }) == 0);
+        CHECK(AllocationsOf([&] { EncodeAllOf<DoubleMetaphone>(names); }) == 0);
+        CHECK(AllocationsOf([&] { EncodeAllOf<Nysiis>(names); }) == 0);
+        CHECK(AllocationsOf([&] { EncodeAllOf<RefinedSoundex>(names); }) == 0);
+        // The cache is allocated on a thread's first use
+        EncodeAllOf<PhoneticEncoder::Cached<Soundex>>(names);
+        CHECK(AllocationsOf([&] { EncodeAllOf<PhoneticEncoder::Cached<Soundex>>(names); }) == 0);
+    }
+
+    SECTION("Several keys at once")
+    {
+        auto keys = MultiKey::Keys<>{};
+        CHECK(AllocationsOf(
+                  [&]
+                  {
+                      for (const auto name : names)
+                          MultiKey::EncodeInto(name, keys);
+                  }) == 0);
+    }
+}
+
+TEST_CASE("Test batch encoding and index queries do not allocate in steady state", "[Allocations]")
+{
+    auto names = std::vector<std::string_view>{};
+    for (std::size_t i = 0; i < 100; ++i)
+        for (const auto name : Names())
+            names.push_back(name);
+
+    SECTION("Batch encoding into reused columns")
+    {
+        auto columns = std::tuple<BatchEncode::Column<SoundexCode>, BatchEncode::Column<DaitchMokotoffCode>>{};
+        BatchEncode::EncodeColumnsInto<Soundex, DaitchMokotoff>(names, columns);
+        CHECK(AllocationsOf([&] { BatchEncode::EncodeColumnsInto<Soundex, DaitchMokotoff>(names, columns); }) == 0);
+        CHECK(std::get<0>(columns).rejected == 200);
+    }
+
+    SECTION("Batch encoding on several threads allocates per thread, not per name")
+    {
+        auto columns = std::tuple<BatchEncode::Column<SoundexCode>>{};
+        const auto few = std::vector<std::string_view>(std::begin(names), std::begin(names) + 100);
+        const auto few_allocations =
+            AllocationsOf([&] { BatchEncode::EncodeColumnsInto<Soundex>(few, columns, 4); });
+        const auto many_allocations =
+            AllocationsOf([&] { BatchEncode::EncodeColumnsInto<Soundex>(names, columns, 4); });
+        CHECK(many_allocations <= few_allocations + 4);
+    }
+
+    SECTION("Index lookups")
+    {
+        const auto code_index = CodeIndex<DaitchMokotoff>{ names };
+        auto ids = std::vector<std::uint32_t>{};
+        for (const auto name : names)
+            code_index.LookupInto(name, ids);
+        CHECK(AllocationsOf(
+                  [&]
+                  {
+                      for (const auto name : names)
+                          code_index.LookupInto(name, ids);
+                  }) == 0);
+
+        const auto phonetic_index = PhoneticIndex{ names };
+        auto found = std::size_t{ 0 };
+        CHECK(AllocationsOf(
+                  [&]
+                  {
+                      for (const auto name : names)
+                          found += std::size(phonetic_index.Lookup(name));
+                  }) == 0);
+        CHECK(found > 0);
+    }
+}
+
+TEST_CASE("Test allocations of the legacy string encoding", "[Allocations]")
+{
+    // Soundex::Encode returns a std::string, short enough for its own buffer; names
+    // that are not ASCII are folded to a new string first
+    const auto ascii = std::vector<std::string>{ "Ashcraft", "Tymczak", "Wolfeschlegelsteinhausenbergerdorff" };
+    const auto accented = std::vector<std::string>{ "Müller", "Łukasz", "Παπαδόπουλος" };
+    Soundex::Encode("Robert");
+    const auto allocations_of = [](const std::vector<std::string>& words)
+    {
+        return AllocationsOf(
+            [&]
+            {
+                for (const auto& word : words)
+                    Soundex::Encode(word);
+            });
+    };
+    const auto ascii_allocations = allocations_of(ascii);
+    const auto accented_allocations = allocations_of(accented);
+
+    auto report = std::ostringstream{};
+    report << "Soundex::Encode allocations per name: " << static_cast<double>(ascii_allocations) / 3.0
+           << " ASCII, " << static_cast<double>(accented_allocations) / 3.0 << " accented";
+    WARN(report.str());
+    CHECK(ascii_allocations == 0);
+    CHECK(accented_allocations <= std::size(accented));
+}
+
+TEST_CASE("Test external sort stays within its memory budget", "[Allocations]")
+{
+    // Enough names for several budgets, with codes all over the rank range
+    auto names = std::string{};
+    auto seed = std::uint32_t{ 1 };
+    for (std::size_t i = 0; i < 200000; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        names += static_cast<char>('A' + (seed >> 8) % 26);
+        for (auto size = 4 + (seed >> 16) % 8; size > 0; --size)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            names += static_cast<char>('a' + (seed >> 8) % 26);
+        }
+        names += '\n';
+    }
+    auto options = ExternalSort::Options{};
+    options.memory_budget = std::size_t{ 1 } << 20;
+    options.fanout = 16;
+    // File streams, spill file paths and the current line
+    constexpr std::size_t SLACK{ 64 * 1024 };
+
+    auto input = std::istringstream{ names };
+    auto discard = NullBuffer{};
+    auto output = std::ostream{ &discard };
+    auto stats = ExternalSort::Stats{};
+    const auto peak = PeakBytesOf([&] { stats = ExternalSort::SortByCode(input, output, options); });
+
+    auto report = std::ostringstream{};
+    report << "External sort peak: " << peak << " bytes for a budget of " << options.memory_budget;
+    WARN(report.str());
+    CHECK(stats.records == 200000);
+    CHECK(stats.spill_files > options.fanout);
+    CHECK(peak <= options.memory_budget + SLACK);
+}
@@ -0,0 +1,111 @@
+#include "catch.hpp"
+
+#include "../batch_encode.hpp"
+#include "../code_index.hpp"
+#include "../daitch_mokotoff.hpp"
+#include "../soundex.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    auto Sorted(std::vector<std::string> codes) -> std::vector<std::string>
+    {
+        std::sort(std::begin(codes), std::end(codes));
+        return codes;
+    }
+} // namespace
+
+TEST_CASE("Test Daitch-Mokotoff encoding", "[DaitchMokotoff]")
+{
+    SECTION("Codes names")
+    {
+        CHECK(DaitchMokotoff::Encode("Lewinsky") == std::vector<std::string>{ "876450" });
+        CHECK(DaitchMokotoff::Encode("Levinski") == std::vector<std::string>{ "876450" });
+        CHECK(DaitchMokotoff::Encode("Szlamawicz") == std::vector<std::string>{ "486740" });
+        CHECK(DaitchMokotoff::Encode("Shlamovitz") == std::vector<std::string>{ "486740" });
+        CHECK(DaitchMokotoff::Encode("Moskowitz") == std::vector<std::string>{ "645740" });
+        CHECK(DaitchMokotoff::Encode("LIPSHITZ") == std::vector<std::string>{ "874400" });
+    }
+
+    SECTION("Gives every combination of alternative codings")
+    {
+        CHECK(Sorted(DaitchMokotoff::Encode("Auerbach")) == std::vector<std::string>{ "097400", "097500" });
+        CHECK(Sorted(DaitchMokotoff::Encode("Ohrbach")) == std::vector<std::string>{ "097400", "097500" });
+        CHECK(Sorted(DaitchMokotoff::Encode("Lippszyc")) == std::vector<std::string>{ "874400", "874500" });
+        CHECK(Sorted(DaitchMokotoff::Encode("Jackson")) ==
+              std::vector<std::string>{ "145460", "154600", "445460", "454600" });
+        CHECK(std::size(DaitchMokotoff::Encode("Rosochowaciec")) == 8);
+    }
+
+    SECTION("Codes differently at the start and before a vowel")
+    {
+        CHECK(Sorted(DaitchMokotoff::Encode("Peters")) == std::vector<std::string>{ "734000", "739400" });
+        CHECK(DaitchMokotoff::Encode("Stein") == std::vector<std::string>{ "260000" });
+        CHECK(DaitchMokotoff::Encode("Kastner") == std::vector<std::string>{ "543690" });
+    }
+
+    SECTION("Rejects what Soundex rejects")
+    {
+        auto codes = std::vector<DaitchMokotoffCode>(DaitchMokotoff::MAX_CODES);
+        CHECK(DaitchMokotoff::EncodeAll("", std::data(codes)) == 0);
+        CHECK(DaitchMokotoff::EncodeAll("Mr.Smith", std::data(codes)) == 0);
+        CHECK_THROWS(DaitchMokotoff::Encode("Name4"));
+    }
+
+    SECTION("Packs codes in order")
+    {
+        const auto code = DaitchMokotoffCode::FromString("097400");
+        CHECK(code.Packed() == 97400);
+        CHECK(code.ToString() == "097400");
+        CHECK(DaitchMokotoffCode::FromRank(code.Rank()) == code);
+        CHECK(code < DaitchMokotoffCode::FromString("097500"));
+        CHECK_THROWS(DaitchMokotoffCode::FromString("09740"));
+    }
+}
+
+TEST_CASE("Test batch encoding and code index", "[BatchEncode][CodeIndex]")
+{
+    const auto names = std::vector<std::string_view>{ "Auerbach", "Ohrbach", "Smith", "Not a name", "Jackson",
+                                                      "Schmidt", "Orbach" };
+
+    SECTION("Encodes a column like one name at a time")
+    {
+        for (const auto thread_count : { std::size_t{ 1 }, std::size_t{ 3 } })
+        {
+            const auto column = BatchEncode::EncodeColumn<DaitchMokotoff>(names, thread_count);
+            REQUIRE(column.Size() == std::size(names));
+            CHECK(column.rejected == 1);
+            for (std::size_t i = 0; i < std::size(names); ++i)
+            {
+                auto codes = std::vector<DaitchMokotoffCode>(DaitchMokotoff::MAX_CODES);
+                codes.resize(DaitchMokotoff::EncodeAll(names[i], std::data(codes)));
+                REQUIRE(column.CodeCount(i) == std::size(codes));
+                CHECK(std::equal(std::begin(codes), std::end(codes), column.CodesOf(i)));
+            }
+        }
+    }
+
+    SECTION("Works with Soundex too")
+    {
+        const auto column = BatchEncode::EncodeColumn<Soundex>(names, 2);
+        CHECK(column.rejected == 1);
+        CHECK(column.CodeCount(3) == 0);
+        CHECK(column.CodesOf(2)->ToString() == "S530");
+    }
+
+    SECTION("Finds names sharing any code")
+    {
+        const auto index = CodeIndex<DaitchMokotoff>{ names };
+        CHECK(index.Size() == 6);
+        CHECK(index.Rejected() == 1);
+        CHECK(index.Lookup("Auerbakh") == std::vector<std::uint32_t>{ 0, 1, 6 });
+        CHECK(index.Ids(DaitchMokotoffCode::FromString("097400")) == std::vector<std::uint32_t>{ 0, 1, 6 });
+        CHECK(index.Lookup("Smith") == std::vector<std::uint32_t>{ 2, 5 });
+        CHECK(index.Lookup("Not a name").empty());
+    }
+}
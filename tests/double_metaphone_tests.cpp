@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include "../batch_encode.hpp"
+#include "../code_index.hpp"
+#include "../double_metaphone.hpp"
+#include "../soundex.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    auto Codes(std::string primary, std::string alternate) -> std::pair<std::string, std::string>
+    {
+        return { std::move(primary), std::move(alternate) };
+    }
+} // namespace
+
+TEST_CASE("Test Double Metaphone encoding", "[DoubleMetaphone]")
+{
+    SECTION("Codes names by sound")
+    {
+        CHECK(DoubleMetaphone::Encode("Knight") == Codes("NT", "NT"));
+        CHECK(DoubleMetaphone::Encode("laugh") == Codes("LF", "LF"));
+        CHECK(DoubleMetaphone::Encode("Edge") == Codes("AJ", "AJ"));
+        CHECK(DoubleMetaphone::Encode("Thomas") == Codes("TMS", "TMS"));
+        CHECK(DoubleMetaphone::Encode("Mcclelland") == Codes("MKLL", "MKLL"));
+    }
+
+    SECTION("Gives an alternate code for a second pronunciation")
+    {
+        CHECK(DoubleMetaphone::Encode("Smith") == Codes("SM0", "XMT"));
+        CHECK(DoubleMetaphone::Encode("Schmidt") == Codes("XMT", "SMT"));
+        CHECK(DoubleMetaphone::Encode("Michael") == Codes("MKL", "MXL"));
+        CHECK(DoubleMetaphone::Encode("Jackson") == Codes("JKSN", "AKSN"));
+        CHECK(DoubleMetaphone::Encode("Arnow") == Codes("ARN", "ARNF"));
+        CHECK(DoubleMetaphone::Encode("Xavier") == Codes("SF", "SFR"));
+        CHECK(DoubleMetaphone::Encode("Filipowicz") == Codes("FLPT", "FLPF"));
+        CHECK(DoubleMetaphone::Encode("Cabrillo") == Codes("KPRL", "KPR"));
+    }
+
+    SECTION("Is case insensitive and rejects what Soundex rejects")
+    {
+        CHECK(DoubleMetaphone::Encode("SCHMIDT") == DoubleMetaphone::Encode("schmidt"));
+        auto codes = DoubleMetaphone::Codes{};
+        CHECK(!DoubleMetaphone::EncodeInto("", codes));
+        CHECK(!DoubleMetaphone::EncodeInto("Van Damme", codes));
+        CHECK_THROWS(DoubleMetaphone::Encode("Name4"));
+    }
+
+    SECTION("Packs codes in order")
+    {
+        const auto code = DoubleMetaphoneCode::FromString("AKSN");
+        CHECK(code.ToString() == "AKSN");
+        CHECK(DoubleMetaphoneCode::FromString("SM0").Size() == 3);
+        CHECK(DoubleMetaphoneCode::FromString("AK") < code);
+        CHECK(code < DoubleMetaphoneCode::FromString("AL"));
+        CHECK(DoubleMetaphoneCode::FromRank(code.Rank()) == code);
+        CHECK_THROWS(DoubleMetaphoneCode::FromString("AKSNT"));
+        CHECK_THROWS(DoubleMetaphoneCode::FromString("ab"));
+    }
+}
+
+TEST_CASE("Test encoding several keys in one pass", "[BatchEncode::EncodeColumns]")
+{
+    const auto names = std::vector<std::string_view>{ "Smith", "Schmidt", "Not a name", "Smyth", "Jackson" };
+
+    SECTION("Gives the same columns as separate passes")
+    {
+        const auto [soundex, metaphone] = BatchEncode::EncodeColumns<Soundex, DoubleMetaphone>(names, 2);
+        const auto metaphone_only = BatchEncode::EncodeColumn<DoubleMetaphone>(names);
+        CHECK(soundex.rejected == 1);
+        CHECK(soundex.CodesOf(1)->ToString() == "S530");
+        CHECK(metaphone.offsets == metaphone_only.offsets);
+        CHECK(metaphone.codes == metaphone_only.codes);
+        CHECK(metaphone.CodeCount(0) == 2);
+        CHECK(metaphone.CodeCount(2) == 0);
+    }
+
+    SECTION("Indexes primary and alternate codes")
+    {
+        const auto index = CodeIndex<DoubleMetaphone>{ names };
+        CHECK(index.Lookup("Schmit") == std::vector<std::uint32_t>{ 0, 1, 3 });
+        CHECK(index.Ids(DoubleMetaphoneCode::FromString("AKSN")) == std::vector<std::uint32_t>{ 4 });
+    }
+}
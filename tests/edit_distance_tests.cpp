@@ -0,0 +1,182 @@
+#include "catch.hpp"
+
+#include "../daitch_mokotoff.hpp"
+#include "../double_metaphone.hpp"
+#include "../edit_distance.hpp"
+#include "../nysiis.hpp"
+#include "../phonetic_index.hpp"
+#include "../refined_soundex.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    // Deterministic strings over a small alphabet, so they share plenty of characters
+    auto RandomWords(std::size_t count, std::size_t max_size, std::uint32_t seed) -> std::vector<std::string>
+    {
+        auto words = std::vector<std::string>{};
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            auto word = std::string(seed % (max_size + 1), 'a');
+            for (auto& c : word)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                c = static_cast<char>("abcdeABC"[seed >> 29]);
+            }
+            words.push_back(word);
+        }
+        return words;
+    }
+} // namespace
+
+TEST_CASE("Test bit-parallel edit distance", "[EditDistance]")
+{
+    SECTION("Computes the Levenshtein distance")
+    {
+        CHECK(EditDistance::Distance("kitten", "sitting") == 3);
+        CHECK(EditDistance::Distance("Robert", "Rupert") == 2);
+        CHECK(EditDistance::Distance("", "abc") == 3);
+        CHECK(EditDistance::Distance("abc", "") == 3);
+        CHECK(EditDistance::Distance("", "") == 0);
+    }
+
+    SECTION("Ignores case")
+    {
+        CHECK(EditDistance::Distance("SMITH", "smyth") == 1);
+    }
+
+    SECTION("Agrees with dynamic programming, across block boundaries")
+    {
+        const auto words = RandomWords(60, 300, 7);
+        for (std::size_t i = 0; i + 1 < words.size(); ++i)
+            CHECK(EditDistance::Distance(words[i], words[i + 1]) ==
+                  EditDistance::ReferenceDistance(words[i], words[i + 1]));
+    }
+
+    SECTION("Stops once over the limit")
+    {
+        const auto pattern = EditDistance::Pattern{ "Abcdefgh" };
+        CHECK(pattern.Distance("Abcdefgh", 0) == 0);
+        CHECK(pattern.Distance("Abcdxxgh", 1) == 2);
+        CHECK(pattern.Distance("Abcdxxgh", 2) == 2);
+        CHECK(pattern.Distance("Zyxwvuts", 3) == 4);
+        CHECK(pattern.Distance("A", 3) == 4);
+    }
+
+    SECTION("Batched distances agree with one at a time")
+    {
+        const auto words = RandomWords(500, 40, 11);
+        const auto views = std::vector<std::string_view>(std::begin(words), std::end(words));
+        for (const auto* query : { "abcab", "", "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA" })
+        {
+            auto distances = std::vector<std::uint32_t>(views.size());
+            EditDistance::Distances(query, views.data(), views.size(), distances.data());
+            for (std::size_t i = 0; i < views.size(); ++i)
+                CHECK(distances[i] == EditDistance::ReferenceDistance(query, views[i]));
+        }
+    }
+
+    SECTION("Batched distances handle candidates longer than a word")
+    {
+        const auto long_word = std::string(70, 'b');
+        const auto views = std::vector<std::string_view>{ "bb", long_word, "", "abb" };
+        auto distances = std::vector<std::uint32_t>(views.size());
+        EditDistance::Distances("abb", views.data(), views.size(), distances.data());
+        CHECK(distances == std::vector<std::uint32_t>{ 1, 68, 3, 0 });
+    }
+
+    SECTION("Batched distances handle an empty candidate after a full word")
+    {
+        const auto full_word = std::string(64, 'b');
+        const auto views = std::vector<std::string_view>{ full_word, "", "abb" };
+        auto distances = std::vector<std::uint32_t>(views.size());
+        EditDistance::Distances("abb", views.data(), views.size(), distances.data());
+        CHECK(distances == std::vector<std::uint32_t>{ 62, 3, 0 });
+    }
+}
+
+TEST_CASE("Test phonetic index", "[PhoneticIndex]")
+{
+    const auto names = std::vector<std::string_view>{ "Robert", "Smith", "Rupert", "R2D2", "Smyth", "Rubin", "Schmidt" };
+    const auto index = PhoneticIndex{ names, 2 };
+
+    SECTION("Buckets names by code, in input order")
+    {
+        CHECK(index.Size() == 6);
+        CHECK(index.Rejected() == 1);
+        const auto bucket = index.Bucket(SoundexCode::FromString("S530"));
+        CHECK(std::vector<std::string_view>(bucket.begin(), bucket.end()) ==
+              std::vector<std::string_view>{ "Smith", "Smyth", "Schmidt" });
+        CHECK(index.Lookup("Robart").size() == 2);
+        CHECK(index.Lookup("Zed").empty());
+        CHECK(index.Lookup("4").empty());
+    }
+
+    SECTION("Maps names back to their input position")
+    {
+        const auto bucket = index.Lookup("Rupert");
+        CHECK(index.Id(bucket.begin()) == 0);
+        CHECK(index.Id(bucket.begin() + 1) == 2);
+    }
+
+    SECTION("Feeds a bucket to the batched edit distance")
+    {
+        const auto bucket = index.Lookup("Smitt");
+        auto distances = std::vector<std::uint32_t>(bucket.size());
+        EditDistance::Distances("Smitt", bucket.data(), bucket.size(), distances.data());
+        CHECK(distances == std::vector<std::uint32_t>{ 1, 2, 3 });
+    }
+
+    SECTION("Buckets names by every code of other encoders")
+    {
+        // Smith and Smyth are SM0 or XMT in Double Metaphone, Schmidt XMT or SMT
+        const auto metaphone_index = BasicPhoneticIndex<DoubleMetaphone>{ names, 2 };
+        CHECK(metaphone_index.Size() == 6);
+        CHECK(metaphone_index.Rejected() == 1);
+        const auto bucket = metaphone_index.Bucket(DoubleMetaphoneCode::FromString("XMT"));
+        CHECK(std::vector<std::string_view>(bucket.begin(), bucket.end()) ==
+              std::vector<std::string_view>{ "Smith", "Smyth", "Schmidt" });
+        auto ids = std::vector<std::uint32_t>{};
+        metaphone_index.LookupInto("Smith", ids);
+        CHECK(ids == std::vector<std::uint32_t>{ 1, 4, 6 });
+        metaphone_index.LookupInto("4", ids);
+        CHECK(ids.empty());
+
+        const auto matches = metaphone_index.Search("Smithe", 5);
+        REQUIRE(std::size(matches) == 3);
+        CHECK(matches[0].name == "Smith");
+        CHECK(matches[1].name == "Smyth");
+        CHECK(matches[2].name == "Schmidt");
+
+        const auto daitch_mokotoff_index = BasicPhoneticIndex<DaitchMokotoff>{ names };
+        daitch_mokotoff_index.LookupInto("Schmit", ids);
+        CHECK(ids == std::vector<std::uint32_t>{ 1, 4, 6 });
+    }
+
+    SECTION("Buckets names by codes without a rank")
+    {
+        // NYSIIS codes take 30 bits, too many for a table of buckets
+        static_assert(!PhoneticEncoder::HAS_RANK<NysiisCode> && PhoneticEncoder::HAS_RANK<DoubleMetaphoneCode>);
+        const auto nysiis_index = BasicPhoneticIndex<Nysiis>{ names, 2 };
+        CHECK(nysiis_index.Size() == 6);
+        CHECK(nysiis_index.Rejected() == 1);
+        const auto bucket = nysiis_index.Lookup("Robart");
+        CHECK(std::vector<std::string_view>(bucket.begin(), bucket.end()) == std::vector<std::string_view>{ "Robert" });
+        CHECK(nysiis_index.Bucket(NysiisCode::FromString("SNAT")).size() == 1);
+        CHECK(nysiis_index.Bucket(NysiisCode::FromString("ZZZ")).empty());
+        CHECK(nysiis_index.Lookup("Zed").empty());
+        const auto matches = nysiis_index.Search("Rubert", 5);
+        REQUIRE(std::size(matches) == 1);
+        CHECK(matches[0].name == "Robert");
+
+        const auto refined_index = BasicPhoneticIndex<RefinedSoundex>{ names };
+        const auto refined_bucket = refined_index.Lookup("Robert");
+        CHECK(std::vector<std::string_view>(refined_bucket.begin(), refined_bucket.end()) ==
+              std::vector<std::string_view>{ "Robert", "Rupert" });
+        CHECK(refined_index.Id(refined_bucket.begin() + 1) == 2);
+    }
+}
@@ -0,0 +1,141 @@
+#include "catch.hpp"
+
+#include "../external_sort.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    auto Lines(const std::string& text) -> std::vector<std::string>
+    {
+        auto lines = std::vector<std::string>{};
+        auto stream = std::istringstream{ text };
+        auto line = std::string{};
+        while (std::getline(stream, line))
+            lines.push_back(line);
+        return lines;
+    }
+
+    auto MakeNames(std::size_t count) -> std::string
+    {
+        const auto stems = std::vector<std::string>{ "Robert", "Rupert", "Ashcraft", "Tymczak", "Pfister",
+                                                     "Jackson", "Lee",    "Gutierrez", "Euler",  "Zimmerman" };
+        auto names = std::string{};
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            names += stems[(i * 7) % stems.size()];
+            names += static_cast<char>('a' + i % 26);
+            names += '\n';
+        }
+        return names;
+    }
+
+    auto SortedInMemory(const std::string& names) -> std::string
+    {
+        auto input = std::istringstream{ names };
+        auto output = std::ostringstream{};
+        ExternalSort::SortByCode(input, output);
+        return output.str();
+    }
+} // namespace
+
+TEST_CASE("Test external sort by Soundex code", "[ExternalSort]")
+{
+    SECTION("Writes code and name, sorted by code and stable within a code")
+    {
+        auto input = std::istringstream{ "Rupert\nAshcraft\nRobert\nLee\n" };
+        auto output = std::ostringstream{};
+        const auto stats = ExternalSort::SortByCode(input, output);
+        CHECK(output.str() == "A261\tAshcraft\nL000\tLee\nR163\tRupert\nR163\tRobert\n");
+        CHECK(stats.records == 4);
+        CHECK(stats.spill_files == 0);
+    }
+
+    SECTION("Skips and counts names that cannot be encoded")
+    {
+        auto input = std::istringstream{ "Lee\n\nR2D2\r\nEuler\r\n" };
+        auto output = std::ostringstream{};
+        const auto stats = ExternalSort::SortByCode(input, output);
+        CHECK(output.str() == "E460\tEuler\nL000\tLee\n");
+        CHECK(stats.rejected == 2);
+    }
+
+    SECTION("Spills to disk when over budget, with the same result as in memory")
+    {
+        const auto names = MakeNames(3000);
+        auto options = ExternalSort::Options{};
+        options.memory_budget = 8 * 1024;
+        options.fanout = 4;
+
+        auto input = std::istringstream{ names };
+        auto output = std::ostringstream{};
+        const auto stats = ExternalSort::SortByCode(input, output, options);
+        CHECK(stats.records == 3000);
+        CHECK(stats.spill_files > 4); // Partitions had to be split again
+        CHECK(stats.spilled_bytes > names.size());
+        CHECK(output.str() == SortedInMemory(names));
+
+        const auto lines = Lines(output.str());
+        CHECK(lines.size() == 3000);
+        CHECK(std::is_sorted(std::begin(lines), std::end(lines),
+                             [](const std::string& lhs, const std::string& rhs)
+                             {
+                                 return lhs.substr(0, 4) < rhs.substr(0, 4);
+                             }));
+    }
+
+    SECTION("Copies through a single code larger than the budget")
+    {
+        auto names = std::string{};
+        for (std::size_t i = 0; i < 2000; ++i)
+            names += (i % 2 == 0 ? "Lee\n" : "Leigh\n");
+        auto options = ExternalSort::Options{};
+        options.memory_budget = 4 * 1024;
+
+        auto input = std::istringstream{ names };
+        auto output = std::ostringstream{};
+        ExternalSort::SortByCode(input, output, options);
+        CHECK(output.str() == SortedInMemory(names));
+    }
+
+    SECTION("Leaves no spill files behind")
+    {
+        auto options = ExternalSort::Options{};
+        options.memory_budget = 4 * 1024;
+        options.spill_directory = std::filesystem::temp_directory_path() / "external_sort_tests";
+        std::filesystem::create_directories(options.spill_directory);
+
+        auto input = std::istringstream{ MakeNames(1000) };
+        auto output = std::ostringstream{};
+        ExternalSort::SortByCode(input, output, options);
+        CHECK(std::filesystem::is_empty(options.spill_directory));
+        std::filesystem::remove_all(options.spill_directory);
+    }
+
+    SECTION("Keeps the partition buffers within the budget")
+    {
+        auto options = ExternalSort::Options{};
+        options.memory_budget = 4 * 1024;
+        options.fanout = 64;
+        auto directory = ExternalSort::Detail::SpillDirectory{ options.spill_directory };
+        auto stats = ExternalSort::Stats{};
+        const auto ranks = ExternalSort::Detail::RankRange{ 0, SoundexCode::RANK_COUNT };
+        const auto partitioner = ExternalSort::Detail::Partitioner{ ranks, options, directory, stats };
+        CHECK(partitioner.BufferBytes() <= options.memory_budget / 2);
+
+        auto input = std::istringstream{ MakeNames(3000) };
+        auto output = std::ostringstream{};
+        ExternalSort::SortByCode(input, output, options);
+        CHECK(output.str() == SortedInMemory(MakeNames(3000)));
+    }
+
+    SECTION("Throws on a spill file it cannot read")
+    {
+        const auto missing = std::filesystem::temp_directory_path() / "external_sort_tests_missing.spill";
+        CHECK_THROWS_AS(ExternalSort::Detail::ForEachRecord(missing, [](std::string_view) {}), std::runtime_error);
+    }
+}
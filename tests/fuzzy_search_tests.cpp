@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include "../phonetic_index.hpp"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    auto Names(const std::vector<PhoneticIndex::Match>& matches) -> std::vector<std::string_view>
+    {
+        auto names = std::vector<std::string_view>{};
+        for (const auto& match : matches)
+            names.push_back(match.name);
+        return names;
+    }
+} // namespace
+
+TEST_CASE("Test top-k fuzzy name search", "[PhoneticIndex::Search]")
+{
+    const auto names = std::vector<std::string_view>{ "Smith",   "Smyth",  "Schmidt", "Smithers", "Robert",  "Rupert",
+                                                      "Roberts", "Kathy",  "Cathy",   "Catherine", "Smit",   "Snith",
+                                                      "Jones",   "Johnson" };
+    const auto index = PhoneticIndex{ names };
+
+    SECTION("Returns the k best names, best first")
+    {
+        const auto matches = index.Search("Smith", 3);
+        CHECK(Names(matches) == std::vector<std::string_view>{ "Smith", "Smyth", "Smit" });
+        CHECK(matches[0].score == 1.0);
+        CHECK(matches[0].id == 0);
+        CHECK(matches[1].score == Approx(0.8));
+    }
+
+    SECTION("Breaks ties by input position")
+    {
+        const auto matches = index.Search("Smoth", 2);
+        CHECK(Names(matches) == std::vector<std::string_view>{ "Smith", "Smyth" });
+    }
+
+    SECTION("Probes codes one digit away")
+    {
+        // "Smiz" is S520, and the names around it are S530
+        CHECK(Names(index.Search("Smiz", 1)) == std::vector<std::string_view>{ "Smit" });
+    }
+
+    SECTION("Probes first letters that sound alike")
+    {
+        CHECK(Names(index.Search("Kathy", 2)) == std::vector<std::string_view>{ "Kathy", "Cathy" });
+    }
+
+    SECTION("Returns fewer names when there are not enough candidates")
+    {
+        CHECK(index.Search("Jones", 10).size() < 10);
+        CHECK(index.Search("Zzyzx", 5).empty());
+        CHECK(index.Search("R2D2", 5).empty());
+        CHECK(index.Search("Smith", 0).empty());
+    }
+
+    SECTION("Agrees with scoring every probed name")
+    {
+        for (const auto* query : { "Robbert", "Catharine", "Smithe", "Jonson", "Rubert" })
+        {
+            const auto matches = index.Search(query, 4);
+            for (std::size_t i = 1; i < matches.size(); ++i)
+                CHECK(matches[i - 1].score >= matches[i].score);
+            // No name left out scores better than the last one returned
+            for (const auto name : names)
+            {
+                const auto in_results = std::any_of(std::begin(matches), std::end(matches),
+                                                    [name](const auto& match)
+                                                    {
+                                                        return match.name == name;
+                                                    });
+                const auto longest = std::max(std::string_view{ query }.size(), name.size());
+                const auto score =
+                    1.0 - static_cast<double>(EditDistance::Distance(query, name)) / static_cast<double>(longest);
+                if (!in_results && matches.size() == 4 && Soundex::Encode(query) == Soundex::Encode(std::string{ name }))
+                    CHECK(score <= matches.back().score);
+            }
+        }
+    }
+}
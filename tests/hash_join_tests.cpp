@@ -0,0 +1,108 @@
+#include "catch.hpp"
+
+#include "../hash_join.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    struct Collector
+    {
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> pairs;
+
+        auto operator()(const HashJoin::Pair* begin, std::size_t count) -> void
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                pairs.emplace_back(begin[i].build_id, begin[i].probe_id);
+        }
+
+        auto Sorted() const -> std::vector<std::pair<std::uint32_t, std::uint64_t>>
+        {
+            auto sorted = pairs;
+            std::sort(std::begin(sorted), std::end(sorted));
+            return sorted;
+        }
+    };
+
+    auto NestedLoopJoin(const std::vector<std::string_view>& build, const std::vector<std::string>& probe)
+        -> std::vector<std::pair<std::uint32_t, std::uint64_t>>
+    {
+        auto pairs = std::vector<std::pair<std::uint32_t, std::uint64_t>>{};
+        for (std::uint32_t b = 0; b < build.size(); ++b)
+            for (std::uint64_t p = 0; p < probe.size(); ++p)
+            {
+                const auto build_code = Soundex::TryEncodePacked(std::string{ build[b] });
+                const auto probe_code = Soundex::TryEncodePacked(probe[p]);
+                if (build_code.has_value() && probe_code.has_value() && *build_code == *probe_code)
+                    pairs.emplace_back(b, p);
+            }
+        std::sort(std::begin(pairs), std::end(pairs));
+        return pairs;
+    }
+} // namespace
+
+TEST_CASE("Test phonetic hash join", "[HashJoin]")
+{
+    const auto build = std::vector<std::string_view>{ "Robert", "Smith", "Rupert", "Jackson", "4ever", "Smyth", "Lee" };
+    const auto probe = std::vector<std::string>{ "Schmidt", "Rubert", "Leigh", "Zed", "", "Smith", "Jaxon", "Robin" };
+    auto probe_text = std::string{};
+    for (const auto& name : probe)
+        probe_text += name + "\n";
+
+    SECTION("Emits the same pairs as a nested loop join")
+    {
+        auto options = HashJoin::Options{};
+        options.thread_count = 3;
+        options.batch_size = 3;
+        auto input = std::istringstream{ probe_text };
+        auto collector = Collector{};
+        const auto stats = HashJoin::Join(build, input, std::ref(collector), options);
+        CHECK(collector.Sorted() == NestedLoopJoin(build, probe));
+        CHECK(stats.pairs == collector.pairs.size());
+        CHECK(stats.build_rejected == 1);
+        CHECK(stats.probe_rejected == 1);
+        CHECK(stats.probe_records == probe.size() - 1);
+    }
+
+    SECTION("Works with a single partition")
+    {
+        auto options = HashJoin::Options{};
+        options.partition_bits = 0;
+        auto input = std::istringstream{ probe_text };
+        auto collector = Collector{};
+        HashJoin::Join(build, input, std::ref(collector), options);
+        CHECK(collector.Sorted() == NestedLoopJoin(build, probe));
+    }
+
+    SECTION("Rejects more partition bits than codes need")
+    {
+        auto options = HashJoin::Options{};
+        options.partition_bits = HashJoin::MAX_PARTITION_BITS + 1;
+        auto input = std::istringstream{ probe_text };
+        auto collector = Collector{};
+        CHECK_THROWS_AS(HashJoin::Join(build, input, std::ref(collector), options), std::invalid_argument);
+        CHECK(collector.pairs.empty());
+        options.partition_bits = HashJoin::MAX_PARTITION_BITS;
+        HashJoin::Join(build, input, std::ref(collector), options);
+        CHECK(collector.Sorted() == NestedLoopJoin(build, probe));
+    }
+
+    SECTION("Bounds the pairs emitted for a single code")
+    {
+        auto big_build = std::vector<std::string_view>(100, "Smith");
+        auto options = HashJoin::Options{};
+        options.max_pairs_per_code = 150;
+        options.thread_count = 2;
+        auto input = std::istringstream{ "Smith\nSmyth\nSchmidt\nLee\n" };
+        auto collector = Collector{};
+        const auto stats = HashJoin::Join(big_build, input, std::ref(collector), options);
+        CHECK(collector.pairs.size() == 150);
+        CHECK(stats.truncated_pairs == 150);
+    }
+}
@@ -0,0 +1,75 @@
+#include "catch.hpp"
+
+#include "../external_sort.hpp"
+#include "../merge_join.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    auto JoinToStrings(const std::string& left_text, const std::string& right_text) -> std::vector<std::string>
+    {
+        auto left = std::istringstream{ left_text };
+        auto right = std::istringstream{ right_text };
+        auto pairs = std::vector<std::string>{};
+        MergeJoin::Join(left, right,
+                        [&pairs](const MergeJoin::Record& l, const MergeJoin::Record& r)
+                        {
+                            pairs.push_back(l.code.ToString() + " " + std::string{ l.name } + "=" +
+                                            std::string{ r.name });
+                        });
+        return pairs;
+    }
+} // namespace
+
+TEST_CASE("Test sort-merge join on sorted streams", "[MergeJoin]")
+{
+    SECTION("Emits the cross product of every shared code group")
+    {
+        const auto pairs = JoinToStrings("A261\tAshcraft\nR163\tRobert\nR163\tRupert\nS530\tSmith\n",
+                                         "L000\tLee\nR163\tRubert\nS530\tSmyth\nS530\tSchmidt\n");
+        CHECK(pairs == std::vector<std::string>{ "R163 Robert=Rubert", "R163 Rupert=Rubert", "S530 Smith=Smyth",
+                                                 "S530 Smith=Schmidt" });
+    }
+
+    SECTION("Reports groups, pairs and line numbers")
+    {
+        auto left = std::istringstream{ "L000\tLee\nL000\tLeigh\n" };
+        auto right = std::istringstream{ "A000\tAi\nL000\tLeo\n" };
+        auto lines = std::vector<std::uint64_t>{};
+        const auto stats = MergeJoin::Join(left, right,
+                                           [&lines](const MergeJoin::Record& l, const MergeJoin::Record& r)
+                                           {
+                                               lines.push_back(l.line * 10 + r.line);
+                                           });
+        CHECK(lines == std::vector<std::uint64_t>{ 12, 22 });
+        CHECK(stats.groups == 1);
+        CHECK(stats.pairs == 2);
+    }
+
+    SECTION("Throws on unsorted input")
+    {
+        CHECK_THROWS(JoinToStrings("R163\tRobert\nA261\tAshcraft\n", "R163\tRupert\nZ000\tZoe\n"));
+    }
+
+    SECTION("Throws on malformed lines")
+    {
+        CHECK_THROWS(JoinToStrings("Robert\n", "R163\tRupert\n"));
+        CHECK_THROWS(JoinToStrings("R1x3\tRobert\n", "R163\tRupert\n"));
+    }
+
+    SECTION("Joins the output of the external sort")
+    {
+        auto sorted_left = std::ostringstream{};
+        auto sorted_right = std::ostringstream{};
+        auto left_names = std::istringstream{ "Smith\nRobert\nLee\nSmyth\n" };
+        auto right_names = std::istringstream{ "Lea\nSchmidt\nRupert\n" };
+        ExternalSort::SortByCode(left_names, sorted_left);
+        ExternalSort::SortByCode(right_names, sorted_right);
+        CHECK(JoinToStrings(sorted_left.str(), sorted_right.str()) ==
+              std::vector<std::string>{ "L000 Lee=Lea", "R163 Robert=Rupert", "S530 Smith=Schmidt",
+                                        "S530 Smyth=Schmidt" });
+    }
+}
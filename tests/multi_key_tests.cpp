@@ -0,0 +1,53 @@
+#include "catch.hpp"
+
+#include "../double_metaphone.hpp"
+#include "../multi_key.hpp"
+#include "../soundex.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Test encoding several keys at once", "[MultiKey]")
+{
+    const auto names = std::vector<std::string_view>{ "Ashcraft", "Tymczak", "Pfister", "Robert",   "Rupert",
+                                                      "Washington", "Lee",   "Gutierrez", "Smith", "Not a name",
+                                                      "Schmidt",  "",        "Jackson", "Honeyman" };
+
+    SECTION("Gives the keys of the separate encoders")
+    {
+        for (const auto& name : names)
+        {
+            auto keys = MultiKey::Keys<8>{};
+            const auto valid = MultiKey::EncodeInto(name, keys);
+            REQUIRE(valid == Soundex::TryEncodePacked(name).has_value());
+            if (!valid)
+                continue;
+            const auto word = std::string{ name };
+            CHECK(keys.soundex.ToString() == Soundex::Encode(word));
+            CHECK(keys.long_soundex.ToString() == BasicSoundex<8>::Encode(word));
+            CHECK(keys.metaphone.primary.ToString() == DoubleMetaphone::Encode(word).first);
+            CHECK(keys.metaphone.alternate.ToString() == DoubleMetaphone::Encode(word).second);
+        }
+    }
+
+    SECTION("Fills one array per key")
+    {
+        const auto columns = MultiKey::EncodeColumns<6>(names, 3);
+        REQUIRE(std::size(columns.soundex) == std::size(names));
+        CHECK(columns.rejected == 2);
+        CHECK(columns.valid[9] == 0);
+        CHECK(columns.soundex[0].ToString() == "A261");
+        CHECK(columns.long_soundex[0].ToString() == "A26130");
+        CHECK(columns.metaphone[8].ToString() == "SM0");
+        CHECK(columns.metaphone_alternate[8].ToString() == "XMT");
+    }
+
+    SECTION("Takes Soundex prefixes")
+    {
+        const auto code = BasicSoundex<8>::EncodePacked("Washington");
+        CHECK(code.Prefix<4>() == Soundex::EncodePacked("Washington"));
+        CHECK(code.Prefix<6>().ToString() == "W25235");
+        CHECK(code.Prefix<8>() == code);
+    }
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include "../batch_encode.hpp"
+#include "../daitch_mokotoff.hpp"
+#include "../double_metaphone.hpp"
+#include "../nysiis.hpp"
+#include "../phonetic_encoder.hpp"
+#include "../refined_soundex.hpp"
+#include "../soundex.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Test NYSIIS encoding", "[Nysiis]")
+{
+    SECTION("Codes names")
+    {
+        CHECK(Nysiis::Encode("Brian") == "BRAN");
+        CHECK(Nysiis::Encode("Brown") == "BRAN");
+        CHECK(Nysiis::Encode("Capp") == "CAP");
+        CHECK(Nysiis::Encode("Kipp") == "CAP");
+        CHECK(Nysiis::Encode("Dane") == "DAN");
+        CHECK(Nysiis::Encode("Dent") == "DAD");
+        CHECK(Nysiis::Encode("Smith") == "SNAT");
+        CHECK(Nysiis::Encode("Schmidt") == "SNAD");
+        CHECK(Nysiis::Encode("Truman") == "TRANAN");
+    }
+
+    SECTION("Rewrites the start and end of names")
+    {
+        CHECK(Nysiis::Encode("Macintosh") == "MCANT");
+        CHECK(Nysiis::Encode("Knuth") == "NAT");
+        CHECK(Nysiis::Encode("Phillipson") == "FALAPS");
+        CHECK(Nysiis::Encode("Kie") == "CY");
+    }
+
+    SECTION("Rejects what Soundex rejects")
+    {
+        auto code = NysiisCode{};
+        CHECK(!Nysiis::EncodeInto("", code));
+        CHECK_THROWS(Nysiis::Encode("O'Brien"));
+    }
+}
+
+TEST_CASE("Test Refined Soundex encoding", "[RefinedSoundex]")
+{
+    CHECK(RefinedSoundex::Encode("Braz") == "B1905");
+    CHECK(RefinedSoundex::Encode("Caren") == "C30908");
+    CHECK(RefinedSoundex::Encode("Hayers") == "H093");
+    CHECK(RefinedSoundex::Encode("jumped") == "J408106");
+    CHECK(RefinedSoundex::Encode("testing") == "T6036084");
+    CHECK(RefinedSoundex::Encode("Pennsylvania") == "P1083072");
+    CHECK(RefinedSoundexCode::FromString("B1905") < RefinedSoundexCode::FromString("B191"));
+    CHECK_THROWS(RefinedSoundex::Encode("two words"));
+}
+
+TEST_CASE("Test the phonetic encoder interface", "[PhoneticEncoder]")
+{
+    SECTION("Recognises encoders")
+    {
+        STATIC_REQUIRE(PhoneticEncoder::IS_ENCODER<Soundex>);
+        STATIC_REQUIRE(PhoneticEncoder::IS_ENCODER<BasicSoundex<8, SoundexRules::American>>);
+        STATIC_REQUIRE(PhoneticEncoder::IS_ENCODER<DaitchMokotoff>);
+        STATIC_REQUIRE(PhoneticEncoder::IS_ENCODER<DoubleMetaphone>);
+        STATIC_REQUIRE(PhoneticEncoder::IS_ENCODER<Nysiis>);
+        STATIC_REQUIRE(PhoneticEncoder::IS_ENCODER<RefinedSoundex>);
+        STATIC_REQUIRE(PhoneticEncoder::IS_ENCODER<PhoneticEncoder::Cached<DaitchMokotoff>>);
+        STATIC_REQUIRE(!PhoneticEncoder::IS_ENCODER<int>);
+        STATIC_REQUIRE(!PhoneticEncoder::IS_ENCODER<SoundexCode>);
+    }
+
+    SECTION("Gives the first code")
+    {
+        CHECK(PhoneticEncoder::EncodeFirst<Soundex>("Robert")->ToString() == "R163");
+        CHECK(PhoneticEncoder::EncodeFirst<DoubleMetaphone>("Smith")->ToString() == "SM0");
+        CHECK(!PhoneticEncoder::EncodeFirst<Nysiis>("").has_value());
+    }
+
+    SECTION("Caches without changing the codes")
+    {
+        using Cached = PhoneticEncoder::Cached<DaitchMokotoff, 4>;
+        const auto names = std::vector<std::string_view>{ "Auerbach", "Jackson", "Auerbach", "Not a name",
+                                                          "Jackson", "Peters", "Auerbach", "Rosochowaciec",
+                                                          "A name longer than the cache holds", "Peters" };
+        for (const auto thread_count : { std::size_t{ 1 }, std::size_t{ 2 } })
+        {
+            const auto [plain, cached] = BatchEncode::EncodeColumns<DaitchMokotoff, Cached>(names, thread_count);
+            CHECK(plain.offsets == cached.offsets);
+            CHECK(plain.codes == cached.codes);
+        }
+    }
+}
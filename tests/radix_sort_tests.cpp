@@ -0,0 +1,127 @@
+#include "catch.hpp"
+
+#include "../radix_sort.hpp"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Test packed Soundex codes", "[SoundexCode]")
+{
+    SECTION("Round trips through its string form")
+    {
+        CHECK(SoundexCode::FromString("R163").ToString() == "R163");
+        CHECK(SoundexCode::FromString("A000").ToString() == "A000");
+        CHECK(SoundexCode::FromString("Z666").ToString() == "Z666");
+    }
+
+    SECTION("Packs into 14 bits")
+    {
+        CHECK(SoundexCode::FromString("Z666").Packed() < (1u << SoundexCode::BITS));
+    }
+
+    SECTION("Orders like the encoded strings")
+    {
+        CHECK(SoundexCode::FromString("A100") < SoundexCode::FromString("A200"));
+        CHECK(SoundexCode::FromString("B000") < SoundexCode::FromString("C000"));
+        CHECK(SoundexCode::FromString("A666") < SoundexCode::FromString("B000"));
+    }
+
+    SECTION("Ranks densely")
+    {
+        CHECK(SoundexCode::FromString("A000").Rank() == 0);
+        CHECK(SoundexCode::FromString("Z666").Rank() == SoundexCode::RANK_COUNT - 1);
+        CHECK(SoundexCode::FromRank(SoundexCode::FromString("M235").Rank()).ToString() == "M235");
+    }
+
+    SECTION("Rejects malformed codes")
+    {
+        CHECK_THROWS(SoundexCode::FromString("R1630"));
+        CHECK_THROWS(SoundexCode::FromString("r163"));
+        CHECK_THROWS(SoundexCode::FromString("R173"));
+    }
+
+    SECTION("Is what Soundex encodes")
+    {
+        CHECK(Soundex::EncodePacked("Robert").ToString() == Soundex::Encode("Robert"));
+    }
+}
+
+TEST_CASE("Test radix sort by Soundex code", "[RadixSort]")
+{
+    const auto names = std::vector<std::string>{ "Robert", "Rupert", "Ashcraft", "Tymczak", "Pfister", "Rubin",
+                                                 "Jackson", "Ashcroft", "Lee",   "Gutierrez", "Rupert", "Euler" };
+    auto codes = std::vector<SoundexCode>{};
+    for (const auto& name : names)
+        codes.push_back(Soundex::EncodePacked(name));
+
+    const auto is_sorted_by_encoding = [](const std::vector<std::string_view>& sorted)
+    {
+        return std::is_sorted(std::begin(sorted), std::end(sorted),
+                              [](std::string_view lhs, std::string_view rhs)
+                              {
+                                  return Soundex::Encode(std::string{ lhs }) < Soundex::Encode(std::string{ rhs });
+                              });
+    };
+
+    SECTION("Sorts ids by code, keeping original order within a code")
+    {
+        const auto ids = RadixSort::SortedIdsByCode(codes);
+        REQUIRE(ids.size() == names.size());
+        for (std::size_t i = 1; i < ids.size(); ++i)
+        {
+            CHECK(!(codes[ids[i]] < codes[ids[i - 1]]));
+            if (codes[ids[i]] == codes[ids[i - 1]])
+                CHECK(ids[i - 1] < ids[i]);
+        }
+    }
+
+    SECTION("Unstable sort still groups by code")
+    {
+        const auto ids = RadixSort::SortedIdsByCode(codes, RadixSort::Order::Unstable);
+        auto sorted_ids = ids;
+        std::sort(std::begin(sorted_ids), std::end(sorted_ids));
+        for (std::size_t i = 0; i < sorted_ids.size(); ++i)
+            CHECK(sorted_ids[i] == i);
+        for (std::size_t i = 1; i < ids.size(); ++i)
+            CHECK(!(codes[ids[i]] < codes[ids[i - 1]]));
+    }
+
+    SECTION("Matches std::stable_sort on string codes")
+    {
+        auto expected = std::vector<std::string_view>(std::begin(names), std::end(names));
+        std::stable_sort(std::begin(expected), std::end(expected),
+                         [](std::string_view lhs, std::string_view rhs)
+                         {
+                             return Soundex::Encode(std::string{ lhs }) < Soundex::Encode(std::string{ rhs });
+                         });
+        auto sorted = std::vector<std::string_view>(std::begin(names), std::end(names));
+        RadixSort::SortNamesByCode(sorted);
+        CHECK(sorted == expected);
+        CHECK(is_sorted_by_encoding(sorted));
+    }
+
+    SECTION("Parallel sort matches the sequential stable sort")
+    {
+        auto many_ids = std::vector<std::uint32_t>{};
+        auto many_codes = std::vector<SoundexCode>{};
+        for (std::uint32_t i = 0; i < 5000; ++i)
+        {
+            many_ids.push_back(i);
+            many_codes.push_back(codes[(i * 7919u) % codes.size()]);
+        }
+        auto expected_ids = many_ids;
+        auto expected_codes = many_codes;
+        RadixSort::SortByCode(expected_ids, expected_codes);
+        RadixSort::ParallelSortByCode(many_ids, many_codes, 4);
+        CHECK(many_ids == expected_ids);
+        CHECK(many_codes == expected_codes);
+    }
+
+    SECTION("Throws on names that cannot be encoded")
+    {
+        auto sorted = std::vector<std::string_view>{ "Robert", "R2D2" };
+        CHECK_THROWS(RadixSort::SortNamesByCode(sorted));
+    }
+}
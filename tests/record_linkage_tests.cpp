@@ -0,0 +1,154 @@
+#include "catch.hpp"
+
+#include "../csv.hpp"
+#include "../double_metaphone.hpp"
+#include "../jaro_winkler.hpp"
+#include "../nysiis.hpp"
+#include "../record_linkage.hpp"
+#include "../refined_soundex.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("Test Jaro-Winkler similarity", "[JaroWinkler]")
+{
+    SECTION("Matches the published reference values")
+    {
+        CHECK(JaroWinkler::Similarity("MARTHA", "MARHTA") == Approx(0.9611).epsilon(0.0001));
+        CHECK(JaroWinkler::Similarity("DWAYNE", "DUANE") == Approx(0.84).epsilon(0.0001));
+        CHECK(JaroWinkler::Similarity("DIXON", "DICKSONX") == Approx(0.8133).epsilon(0.0001));
+    }
+
+    SECTION("Ignores case")
+    {
+        CHECK(JaroWinkler::Similarity("martha", "MARHTA") == JaroWinkler::Similarity("MARTHA", "MARHTA"));
+    }
+
+    SECTION("Scores identical strings 1 and disjoint strings 0")
+    {
+        CHECK(JaroWinkler::Similarity("Robert", "Robert") == 1.0);
+        CHECK(JaroWinkler::Similarity("abc", "xyz") == 0.0);
+        CHECK(JaroWinkler::Similarity("", "") == 1.0);
+        CHECK(JaroWinkler::Similarity("", "a") == 0.0);
+    }
+
+    SECTION("Agrees with the quadratic version, beyond the pattern size too")
+    {
+        const auto words = std::vector<std::string>{ "Robert", "Rupert", "Ashcraft", "Ashcroft", "Tymczak",
+                                                     std::string(70, 'a') + "b", std::string(65, 'a') };
+        for (const auto& a : words)
+            for (const auto& b : words)
+                CHECK(JaroWinkler::Similarity(a, b) == Approx(JaroWinkler::Detail::ScalarSimilarity(a, b)));
+    }
+
+    SECTION("Can be reassigned")
+    {
+        auto pattern = JaroWinkler::Pattern{ "zzzz" };
+        pattern.Assign("MARHTA");
+        CHECK(pattern.Similarity("MARTHA") == Approx(0.9611).epsilon(0.0001));
+    }
+
+    SECTION("Can be reassigned after a pattern longer than the mask table")
+    {
+        const auto long_name = std::string(JaroWinkler::Pattern::MAX_SIZE + 10, 'a');
+        auto patterns = std::vector<JaroWinkler::Pattern>(1);
+        patterns[0].Assign(long_name);
+        CHECK(patterns[0].Similarity(long_name) == 1.0);
+        patterns[0].Assign("MARHTA");
+        CHECK(patterns[0].Similarity("MARTHA") == Approx(0.9611).epsilon(0.0001));
+    }
+}
+
+TEST_CASE("Test CSV reading", "[Csv]")
+{
+    auto input = std::istringstream{ "a,\"b,c\",\"say \"\"hi\"\"\"\r\n,\"two\nlines\"\n" };
+    auto reader = Csv::Reader{ input };
+    auto fields = std::vector<std::string>{};
+    REQUIRE(reader.ReadRow(fields));
+    CHECK(fields == std::vector<std::string>{ "a", "b,c", "say \"hi\"" });
+    REQUIRE(reader.ReadRow(fields));
+    CHECK(fields == std::vector<std::string>{ "", "two\nlines" });
+    CHECK(!reader.ReadRow(fields));
+}
+
+TEST_CASE("Test record linkage", "[RecordLinkage]")
+{
+    const auto left_csv = std::string{ "surname,given\nSmith,John\nRobert,Anne\nJackson,Peter\n4ever,Young\n" };
+    const auto right_csv = std::string{ "surname,given\nSmyth,Jon\nRupert,Anna\nSmith,Jane\nJaxon,Paul\n" };
+
+    SECTION("Writes pairs of the same block scoring over the threshold")
+    {
+        auto left = std::istringstream{ left_csv };
+        auto right = std::istringstream{ right_csv };
+        auto output = std::ostringstream{};
+        auto options = RecordLinkage::Options{};
+        options.thread_count = 2;
+        options.batch_size = 3;
+        const auto stats = RecordLinkage::Link(left, right, output, options);
+        // Every right record finds a block, but only Smyth/Jon scores over the threshold
+        CHECK(output.str() == "left_row,right_row,score\n0,0,0.9133\n");
+        CHECK(stats.left_records == 3);
+        CHECK(stats.right_records == 4);
+        CHECK(stats.rejected == 1);
+        CHECK(stats.candidate_pairs == 4);
+        CHECK(stats.matches == 1);
+    }
+
+    SECTION("Blocks on the surname alone when configured")
+    {
+        const auto link = [](RecordLinkage::Options options)
+        {
+            auto left = std::istringstream{ "Smith,John\n" };
+            auto right = std::istringstream{ "Smyth,Mary\n" };
+            auto output = std::ostringstream{};
+            options.has_header = false;
+            options.threshold = 0.0;
+            return RecordLinkage::Link(left, right, output, options).candidate_pairs;
+        };
+        auto options = RecordLinkage::Options{};
+        CHECK(link(options) == 0);
+        options.given_name_column.reset();
+        CHECK(link(options) == 1);
+        options.given_name_column = 1;
+        options.initials = 0;
+        CHECK(link(options) == 1);
+    }
+
+    SECTION("Blocks with any phonetic encoder")
+    {
+        const auto link = [](auto encoder)
+        {
+            auto left = std::istringstream{ "Kathy,Anne\n" };
+            auto right = std::istringstream{ "Cathy,Anne\n" };
+            auto output = std::ostringstream{};
+            auto options = RecordLinkage::Options{};
+            options.has_header = false;
+            return RecordLinkage::Link<decltype(encoder)>(left, right, output, options).matches;
+        };
+        CHECK(link(Soundex{}) == 0);
+        CHECK(link(Nysiis{}) == 1);
+        CHECK(link(PhoneticEncoder::Cached<Nysiis>{}) == 1);
+
+        auto left = std::istringstream{ left_csv };
+        auto right = std::istringstream{ right_csv };
+        auto output = std::ostringstream{};
+        auto options = RecordLinkage::Options{};
+        options.initials = RecordLinkage::MaxInitials<RefinedSoundex>() + 1;
+        CHECK_THROWS_AS(RecordLinkage::Link<RefinedSoundex>(left, right, output, options), std::invalid_argument);
+    }
+
+    SECTION("Blocks on every code of a name, scoring each pair once")
+    {
+        // Smith is SM0 or XMT in Double Metaphone, Schmidt XMT or SMT
+        auto left = std::istringstream{ "Smith,John\nSchmidt,John\n" };
+        auto right = std::istringstream{ "Schmidt,John\nSmith,John\n" };
+        auto output = std::ostringstream{};
+        auto options = RecordLinkage::Options{};
+        options.has_header = false;
+        options.threshold = 0.0;
+        const auto stats = RecordLinkage::Link<DoubleMetaphone>(left, right, output, options);
+        CHECK(stats.candidate_pairs == 4);
+        CHECK(output.str() == "left_row,right_row,score\n0,0,0.8682\n1,0,1.0000\n0,1,1.0000\n1,1,0.8682\n");
+    }
+}
@@ -0,0 +1,122 @@
+//
+// A frozen copy of Soundex::Encode, the reference the optimized engines are checked
+// against in soundex_differential.hpp.
+//
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../unicode.hpp"
+
+// The letter by letter algorithm of the original Soundex::Encode, kept here unchanged
+// so that making Encode itself faster cannot move the reference with it. Words that
+// are not ASCII are folded with Unicode::FoldToAscii first, as Encode does; the
+// transliteration tables are shared, not frozen, and unicode_tests.cpp covers them.
+namespace ReferenceSoundex
+{
+    namespace Detail
+    {
+        inline auto Digit(char letter) -> std::optional<char>
+        {
+            switch (std::tolower(static_cast<unsigned char>(letter)))
+            {
+            case 'b':
+            case 'f':
+            case 'p':
+            case 'v':
+                return '1';
+            case 'c':
+            case 'g':
+            case 'j':
+            case 'k':
+            case 'q':
+            case 's':
+            case 'x':
+            case 'z':
+                return '2';
+            case 'd':
+            case 't':
+                return '3';
+            case 'l':
+                return '4';
+            case 'm':
+            case 'n':
+                return '5';
+            case 'r':
+                return '6';
+            default:
+                return std::nullopt;
+            }
+        }
+
+        inline auto IsVowel(char letter) -> bool
+        {
+            return std::string_view{ "aeiouAEIOU" }.find(letter) != std::string_view::npos;
+        }
+
+        inline auto IsIgnored(char letter) -> bool
+        {
+            return std::string_view{ "whyWHY" }.find(letter) != std::string_view::npos;
+        }
+
+        inline auto EncodeAscii(std::string_view word, std::size_t size) -> std::optional<std::string>
+        {
+            if (word.empty())
+                return std::nullopt;
+            for (const auto c : word)
+                if (!std::isalpha(static_cast<unsigned char>(c)))
+                    return std::nullopt;
+
+            // The digit of the first letter, so that a second letter with the same
+            // digit is not encoded
+            auto digits = std::string{ Digit(word.front()).value_or('*') };
+            auto last_letter = char{ '*' };
+            auto encoded_consonants = std::size_t{ 0 };
+            for (const auto letter : word.substr(1))
+            {
+                if (!IsVowel(letter) && !IsIgnored(letter))
+                {
+                    const auto digit = Digit(letter);
+                    if (!digit.has_value())
+                    {
+                        last_letter = letter;
+                        continue;
+                    }
+                    if (*digit != digits.back() || IsVowel(last_letter))
+                    {
+                        digits.push_back(*digit);
+                        ++encoded_consonants;
+                    }
+                }
+                last_letter = letter;
+                if (encoded_consonants + 1 == size)
+                    break;
+            }
+            digits.front() = static_cast<char>(std::toupper(static_cast<unsigned char>(word.front())));
+            if (std::size(digits) < size)
+                digits.resize(size, '0');
+            return digits;
+        }
+    } // namespace Detail
+
+    // The Soundex code of size characters of word, or std::nullopt where
+    // Soundex::Encode throws
+    inline auto Encode(std::string_view word, std::size_t size = 4) -> std::optional<std::string>
+    {
+        for (const auto c : word)
+        {
+            if (static_cast<unsigned char>(c) >= 0x80)
+            {
+                const auto folded = Unicode::FoldToAscii(word);
+                if (!folded.has_value())
+                    return std::nullopt;
+                return Detail::EncodeAscii(*folded, size);
+            }
+        }
+        return Detail::EncodeAscii(word, size);
+    }
+} // namespace ReferenceSoundex
@@ -99,6 +99,97 @@ TEST_CASE("Test Soundex Encoding", "[Soundex::encoding]")
     }
 }
 
+TEST_CASE("Test packed Soundex encoding", "[Soundex::EncodeInto]")
+{
+    const auto words = std::vector<std::string>{ "A",        "Ab",      "Bf",      "Acdl",    "Dcdlb",   "Baeiouhycdl",
+                                                 "Abfcgdt",  "Abdtl",   "abcd",    "BCDL",    "Bbcd",    "Jbob",
+                                                 "Ashcraft", "Tymczak", "Pfister", "Robert",  "Rupert",  "Washington",
+                                                 "Lee",      "Gutierrez", "Honeyman", "Shhhhhh", "Yy", "Euler" };
+
+    SECTION("Agrees with the string encoding")
+    {
+        for (const auto& word : words)
+            CHECK(Soundex::EncodePacked(word).ToString() == Soundex::Encode(word));
+    }
+
+    SECTION("Rejects what Encode rejects")
+    {
+        auto code = SoundexCode::FromString("Z666");
+        CHECK(!Soundex::EncodeInto("", code));
+        CHECK(!Soundex::EncodeInto("Mr.Smith", code));
+        CHECK(!Soundex::EncodeInto("Normalwordbutnumber4", code));
+        CHECK(!Soundex::TryEncodePacked("Some sentence with spaces").has_value());
+        CHECK(code.ToString() == "Z666");
+        CHECK_THROWS(Soundex::EncodePacked("123"));
+    }
+
+    SECTION("Supports longer codes")
+    {
+        CHECK(BasicSoundex<6>::Encode("Ashcraft") == "A26130");
+        CHECK(BasicSoundex<8>::Encode("Washington") == "W2523500");
+        for (const auto& word : words)
+        {
+            CHECK(BasicSoundex<6>::EncodePacked(word).ToString() == BasicSoundex<6>::Encode(word));
+            CHECK(BasicSoundex<8>::EncodePacked(word).ToString() == BasicSoundex<8>::Encode(word));
+            CHECK(BasicSoundex<8>::Encode(word).substr(0, 4) == Soundex::Encode(word));
+        }
+    }
+
+    SECTION("Packs into the smallest integer that fits")
+    {
+        CHECK(sizeof(BasicSoundex<4>::Code) == 2);
+        CHECK(sizeof(BasicSoundex<8>::Code) == 4);
+        CHECK(sizeof(BasicSoundex<12>::Code) == 8);
+    }
+}
+
+namespace
+{
+    struct AmericanWithoutFirstLetterSuppression : SoundexRules::American
+    {
+        static constexpr bool FIRST_LETTER_SUPPRESSES_DUPLICATE{ false };
+    };
+} // namespace
+
+TEST_CASE("Test Soundex dialects", "[SoundexRules]")
+{
+    using American = BasicSoundex<4, SoundexRules::American>;
+    using Simplified = BasicSoundex<4, SoundexRules::Simplified>;
+
+    SECTION("Legacy rules are the default")
+    {
+        CHECK(Soundex::Encode("Bohb") == "B000");
+        CHECK(Soundex::Encode("Byb") == "B000");
+    }
+
+    SECTION("American rules let 'h' and 'w' through and separate on 'y'")
+    {
+        CHECK(American::Encode("Ashcraft") == "A261");
+        CHECK(American::Encode("Tymczak") == "T522");
+        CHECK(American::Encode("Pfister") == "P236");
+        CHECK(American::Encode("Bohb") == "B100");
+        CHECK(American::Encode("Byb") == "B100");
+        CHECK(American::Encode("Bhb") == "B000");
+    }
+
+    SECTION("Simplified rules separate on every uncoded letter")
+    {
+        CHECK(Simplified::Encode("Ashcraft") == "A226");
+        CHECK(Simplified::Encode("Bhb") == "B100");
+    }
+
+    SECTION("First letter suppression is a rule too")
+    {
+        CHECK(BasicSoundex<4, AmericanWithoutFirstLetterSuppression>::Encode("Pfister") == "P123");
+    }
+
+    SECTION("Dialects reject the same inputs")
+    {
+        CHECK_THROWS(American::Encode("Mr.Smith"));
+        CHECK(!Simplified::TryEncodePacked("").has_value());
+    }
+}
+
 // Test list
 // Manage one letter words
 // Fail when given multiple words as input
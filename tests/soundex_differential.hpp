@@ -0,0 +1,203 @@
+//
+// Cross-checks of every Soundex engine against the frozen reference, shared by the
+// property test and the fuzz target.
+//
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "../batch_encode.hpp"
+#include "../multi_key.hpp"
+#include "../phonetic_encoder.hpp"
+#include "../soundex.hpp"
+#include "../unicode.hpp"
+#include "reference_soundex.hpp"
+
+// Each engine must accept exactly the words the reference accepts and give them the
+// same code: the packed state machine over ASCII (found with SIMD or SWAR) and over
+// decoded UTF-8, UTF-16, UTF-32 and wide text, the cached encoder on a miss and on a
+// hit, MultiKey, and batch encoding on one thread and on several. Soundex::Encode is
+// checked too, so that speeding it up cannot change its results, and so are the 6 and
+// 8 character codes of BasicSoundex and of MultiKey's long key.
+namespace SoundexDifferential
+{
+    // An engine whose result differs from the reference on word
+    struct Mismatch
+    {
+        std::string engine;
+        std::string word;
+        std::optional<std::string> expected;
+        std::optional<std::string> actual;
+
+        auto Describe() const -> std::string
+        {
+            const auto show = [](const std::optional<std::string>& code) { return code.value_or("rejected"); };
+            auto bytes = std::string{};
+            for (const auto c : word)
+            {
+                static constexpr char HEX[] = "0123456789ABCDEF";
+                const auto byte = static_cast<unsigned char>(c);
+                bytes += { '\\', 'x', HEX[byte >> 4], HEX[byte & 0xF] };
+            }
+            return engine + " on \"" + bytes + "\": expected " + show(expected) + ", got " + show(actual);
+        }
+    };
+
+    namespace Detail
+    {
+        template <std::size_t N>
+        auto Show(bool accepted, const BasicSoundexCode<N>& code) -> std::optional<std::string>
+        {
+            if (!accepted)
+                return std::nullopt;
+            return code.ToString();
+        }
+
+        // The code points of word, or std::nullopt if it is not valid UTF-8
+        inline auto CodePoints(std::string_view word) -> std::optional<std::u32string>
+        {
+            auto code_points = std::u32string{};
+            for (auto position = std::size_t{ 0 }; position < std::size(word);)
+            {
+                const auto code_point = Unicode::Decode(word, position);
+                if (code_point == Unicode::INVALID)
+                    return std::nullopt;
+                code_points.push_back(code_point);
+            }
+            return code_points;
+        }
+
+        inline auto ToUtf16(std::u32string_view code_points) -> std::u16string
+        {
+            auto text = std::u16string{};
+            for (const auto code_point : code_points)
+            {
+                if (code_point < 0x10000)
+                {
+                    text.push_back(static_cast<char16_t>(code_point));
+                    continue;
+                }
+                text.push_back(static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10)));
+                text.push_back(static_cast<char16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF)));
+            }
+            return text;
+        }
+
+        // Codes of N characters from the long Soundex engines, checked against the
+        // reference cut at N
+        template <std::size_t N, typename Check>
+        auto CheckLong(std::string_view word, Check& check) -> void
+        {
+            const auto expected = ReferenceSoundex::Encode(word, N);
+            const auto size = std::to_string(N);
+            auto code = BasicSoundexCode<N>{};
+            check("BasicSoundex<" + size + ">::EncodeInto", expected,
+                  Show(BasicSoundex<N>::EncodeInto(word, code), code));
+            const auto packed = BasicSoundex<N>::TryEncodePacked(word);
+            check("BasicSoundex<" + size + ">::TryEncodePacked", expected,
+                  Show(packed.has_value(), packed.value_or(BasicSoundexCode<N>{})));
+            auto keys = MultiKey::Keys<N>{};
+            check("MultiKey::Keys<" + size + ">::long_soundex", expected,
+                  Show(MultiKey::EncodeInto(word, keys), keys.long_soundex));
+        }
+
+        template <typename CharT>
+        auto EncodeWide(std::basic_string_view<CharT> word) -> std::optional<std::string>
+        {
+            auto code = SoundexCode{};
+            return Show(Soundex::EncodeInto(word, code), code);
+        }
+    } // namespace Detail
+
+    // Runs the engines that take one word at a time; returns the first that disagrees
+    // with the reference
+    inline auto CheckWord(std::string_view word) -> std::optional<Mismatch>
+    {
+        const auto expected = ReferenceSoundex::Encode(word);
+        auto mismatch = std::optional<Mismatch>{};
+        auto check_against = [&](const std::string& engine, const std::optional<std::string>& expected_code,
+                                 const std::optional<std::string>& actual)
+        {
+            if (!mismatch.has_value() && actual != expected_code)
+                mismatch = Mismatch{ engine, std::string{ word }, expected_code, actual };
+        };
+        const auto check = [&](const char* engine, const std::optional<std::string>& actual)
+        {
+            check_against(engine, expected, actual);
+        };
+
+        auto ascii = true;
+        for (const auto c : word)
+            ascii = ascii && static_cast<unsigned char>(c) < 0x80;
+        if (Unicode::IsAscii(word) != ascii)
+            return Mismatch{ "Unicode::IsAscii", std::string{ word }, ascii ? "ASCII" : "not ASCII",
+                             ascii ? "not ASCII" : "ASCII" };
+
+        try
+        {
+            check("Soundex::Encode", Soundex::Encode(std::string{ word }));
+        }
+        catch (const std::runtime_error&)
+        {
+            check("Soundex::Encode", std::nullopt);
+        }
+
+        auto code = SoundexCode{};
+        check("Soundex::EncodeInto", Detail::Show(Soundex::EncodeInto(word, code), code));
+        const auto packed = Soundex::TryEncodePacked(word);
+        check("Soundex::TryEncodePacked", Detail::Show(packed.has_value(), packed.value_or(SoundexCode{})));
+
+        // A miss, then a hit
+        for (const auto engine : { "Cached<Soundex> (miss)", "Cached<Soundex> (hit)" })
+        {
+            code = SoundexCode{};
+            check(engine, Detail::Show(PhoneticEncoder::Cached<Soundex>::EncodeAll(word, &code) == 1, code));
+        }
+
+        auto keys = MultiKey::Keys<>{};
+        check("MultiKey::EncodeInto", Detail::Show(MultiKey::EncodeInto(word, keys), keys.soundex));
+
+        Detail::CheckLong<6>(word, check_against);
+        Detail::CheckLong<8>(word, check_against);
+
+        const auto code_points = Detail::CodePoints(word);
+        if (code_points.has_value())
+        {
+            const auto utf16 = Detail::ToUtf16(*code_points);
+            check("Soundex::EncodeInto (UTF-16)", Detail::EncodeWide(std::u16string_view{ utf16 }));
+            check("Soundex::EncodeInto (UTF-32)", Detail::EncodeWide(std::u32string_view{ *code_points }));
+            auto wide = std::wstring{};
+            if constexpr (sizeof(wchar_t) == sizeof(char32_t))
+                wide.assign(std::begin(*code_points), std::end(*code_points));
+            else
+                wide.assign(std::begin(utf16), std::end(utf16));
+            check("Soundex::EncodeInto (wide)", Detail::EncodeWide(std::wstring_view{ wide }));
+        }
+        return mismatch;
+    }
+
+    // Encodes words as a column with thread_count threads and returns the first word
+    // whose code disagrees with the reference
+    inline auto CheckBatch(const std::vector<std::string_view>& words, std::size_t thread_count)
+        -> std::optional<Mismatch>
+    {
+        auto columns = std::tuple<BatchEncode::Column<SoundexCode>>{};
+        BatchEncode::EncodeColumnsInto<Soundex>(words, columns, thread_count);
+        const auto& column = std::get<0>(columns);
+        const auto engine = thread_count == 1 ? "BatchEncode (one thread)" : "BatchEncode (several threads)";
+        for (std::size_t i = 0; i < std::size(words); ++i)
+        {
+            const auto expected = ReferenceSoundex::Encode(words[i]);
+            const auto actual = column.CodeCount(i) == 1 ? std::optional{ column.codes[column.offsets[i]].ToString() }
+                                                         : std::nullopt;
+            if (actual != expected)
+                return Mismatch{ engine, std::string{ words[i] }, expected, actual };
+        }
+        return std::nullopt;
+    }
+} // namespace SoundexDifferential
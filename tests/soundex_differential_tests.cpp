@@ -0,0 +1,167 @@
+#include "catch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "soundex_differential.hpp"
+
+namespace
+{
+    auto AppendUtf8(std::string& text, char32_t code_point) -> void
+    {
+        if (code_point < 0x80)
+        {
+            text.push_back(static_cast<char>(code_point));
+        }
+        else if (code_point < 0x800)
+        {
+            text.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+            text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+        else if (code_point < 0x10000)
+        {
+            text.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+            text.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+        else
+        {
+            text.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+            text.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+            text.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            text.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+    }
+
+    // Random words built to reach the corners of the rules: letters of one digit in a
+    // row, separated by vowels or by h, w and y, mixed case, characters that are not
+    // letters, accented, Greek and Cyrillic letters, other scripts, and bytes that are
+    // not UTF-8
+    class WordGenerator
+    {
+    public:
+        explicit WordGenerator(std::uint32_t seed) : random_{ seed }
+        {
+        }
+
+        auto Next() -> std::string
+        {
+            static constexpr std::string_view ALPHABETS[] = {
+                "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ",
+                "bfpvBFPVhwyHWYa", // Digit 1, with the letters that do not separate
+                "cgjkqsxzCSdtlmnraeiouhw",
+                "aeiouyhwAEIOUYHW",
+            };
+            const auto& alphabet = ALPHABETS[Below(std::size(ALPHABETS))];
+            const auto size = Below(4) == 0 ? Below(70) : 1 + Below(12);
+            auto word = std::string{};
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const auto kind = Below(100);
+                if (kind < 90)
+                    word.push_back(alphabet[Below(std::size(alphabet))]);
+                else if (kind < 93)
+                    word.push_back(" -'0.\x7F"[Below(6)]);
+                else if (kind < 98)
+                    AppendUtf8(word, CodePoint());
+                else
+                    word.push_back(static_cast<char>(0x80 + Below(0x80)));
+            }
+            return word;
+        }
+
+    private:
+        auto Below(std::size_t bound) -> std::size_t
+        {
+            return std::uniform_int_distribution<std::size_t>{ 0, bound - 1 }(random_);
+        }
+
+        auto CodePoint() -> char32_t
+        {
+            // Latin-1 and Latin Extended-A, Greek, Cyrillic, then others
+            static constexpr char32_t RANGES[][2] = { { 0xC0, 0x180 },   { 0x380, 0x3D0 },     { 0x400, 0x460 },
+                                                      { 0x100, 0x2000 }, { 0x4E00, 0x4E40 },   { 0x1F600, 0x1F640 } };
+            const auto& range = RANGES[Below(std::size(RANGES))];
+            return static_cast<char32_t>(range[0] + Below(range[1] - range[0]));
+        }
+
+        std::mt19937 random_;
+    };
+} // namespace
+
+TEST_CASE("Every Soundex engine agrees with the reference", "[soundex][differential]")
+{
+    SECTION("The reference is the original Soundex")
+    {
+        CHECK(ReferenceSoundex::Encode("Robert") == "R163");
+        CHECK(ReferenceSoundex::Encode("Ashcraft") == "A261");
+        CHECK(ReferenceSoundex::Encode("Pfister") == "P236");
+        CHECK(ReferenceSoundex::Encode("Müller") == "M460");
+        CHECK(ReferenceSoundex::Encode("O'Hara") == std::nullopt);
+        CHECK(ReferenceSoundex::Encode("") == std::nullopt);
+    }
+
+    SECTION("All words of up to three letters")
+    {
+        static constexpr std::string_view LETTERS = "abcdefghijklmnopqrstuvwxyzAHWY";
+        auto words = std::vector<std::string>{ "" };
+        for (std::size_t size = 1; size <= 3; ++size)
+        {
+            auto longer = std::vector<std::string>{};
+            for (const auto& word : words)
+                for (const auto letter : LETTERS)
+                    longer.push_back(word + letter);
+            for (const auto& word : longer)
+            {
+                const auto mismatch = SoundexDifferential::CheckWord(word);
+                INFO((mismatch.has_value() ? mismatch->Describe() : ""));
+                REQUIRE_FALSE(mismatch.has_value());
+            }
+            words = std::move(longer);
+        }
+    }
+
+    SECTION("A character that is not ASCII or not a letter at every position")
+    {
+        // Crosses the 8 and 16 byte blocks of the SWAR and SIMD ASCII checks
+        for (std::size_t size = 1; size <= 40; ++size)
+        {
+            for (std::size_t position = 0; position < size; ++position)
+            {
+                for (const std::string_view odd : { "é", "Ж", "\xFF", "1", " ", "ß", "\xE2\x82" })
+                {
+                    auto word = std::string(size, 'b');
+                    word.replace(position, 1, odd);
+                    const auto mismatch = SoundexDifferential::CheckWord(word);
+                    INFO((mismatch.has_value() ? mismatch->Describe() : ""));
+                    REQUIRE_FALSE(mismatch.has_value());
+                }
+            }
+        }
+    }
+
+    SECTION("Random words, one at a time and in batches")
+    {
+        auto generator = WordGenerator{ 2022 };
+        auto words = std::vector<std::string>{};
+        for (int i = 0; i < 20000; ++i)
+        {
+            words.push_back(generator.Next());
+            const auto mismatch = SoundexDifferential::CheckWord(words.back());
+            INFO((mismatch.has_value() ? mismatch->Describe() : ""));
+            REQUIRE_FALSE(mismatch.has_value());
+        }
+
+        const auto views = std::vector<std::string_view>(std::begin(words), std::end(words));
+        for (const auto thread_count : { std::size_t{ 1 }, std::size_t{ 4 } })
+        {
+            const auto mismatch = SoundexDifferential::CheckBatch(views, thread_count);
+            INFO((mismatch.has_value() ? mismatch->Describe() : ""));
+            REQUIRE_FALSE(mismatch.has_value());
+        }
+    }
+}
@@ -0,0 +1,105 @@
+//
+// Differential fuzz target: every Soundex engine against the frozen reference.
+//
+// Built with -DENABLE_FUZZING=ON and Clang, it is a libFuzzer binary:
+//
+//   soundex_fuzz corpus_directory -max_len=64
+//
+// Otherwise the same target gets a standalone driver, which replays the files given
+// as arguments, or with none runs -runs=N random inputs (default 100000) from
+// -seed=N, so crashes found elsewhere can be replayed with any compiler.
+//
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "soundex_differential.hpp"
+
+namespace
+{
+    auto Fail(const SoundexDifferential::Mismatch& mismatch) -> void
+    {
+        std::fprintf(stderr, "%s\n", mismatch.Describe().c_str());
+        std::abort();
+    }
+} // namespace
+
+// The input is a word, and its lines are also encoded as a batch
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    const auto input = std::string_view{ reinterpret_cast<const char*>(data), size };
+    if (const auto mismatch = SoundexDifferential::CheckWord(input))
+        Fail(*mismatch);
+
+    auto lines = std::vector<std::string_view>{};
+    for (auto begin = std::size_t{ 0 }; begin <= size;)
+    {
+        const auto end = std::min(input.find('\n', begin), size);
+        lines.push_back(input.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    for (const auto thread_count : { std::size_t{ 1 }, std::size_t{ 3 } })
+        if (const auto mismatch = SoundexDifferential::CheckBatch(lines, thread_count))
+            Fail(*mismatch);
+    return 0;
+}
+
+#if !defined(SOUNDEX_LIBFUZZER)
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+int main(int argc, char* argv[])
+{
+    auto runs = std::size_t{ 100000 };
+    auto seed = std::uint32_t{ 1 };
+    auto files = std::vector<std::string>{};
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string_view{ argv[i] };
+        if (argument.substr(0, 6) == "-runs=")
+            runs = std::stoul(std::string{ argument.substr(6) });
+        else if (argument.substr(0, 6) == "-seed=")
+            seed = static_cast<std::uint32_t>(std::stoul(std::string{ argument.substr(6) }));
+        else if (argument.substr(0, 1) != "-") // Other libFuzzer flags are ignored
+            files.emplace_back(argument);
+    }
+
+    for (const auto& path : files)
+    {
+        auto file = std::ifstream{ path, std::ios::binary };
+        if (!file)
+        {
+            std::cerr << "Cannot open " << path << '\n';
+            return EXIT_FAILURE;
+        }
+        const auto input = std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(std::data(input)), std::size(input));
+    }
+    if (!files.empty())
+        return EXIT_SUCCESS;
+
+    // Mostly letters, to get past the validation, with the bytes of separators,
+    // accented letters and broken UTF-8 mixed in
+    static constexpr std::string_view BYTES = "abcdefghijklmnopqrstuvwxyzBCDHLMRSTWYaeiouhwy \n'-0"
+                                              "\xC3\xA9\xD0\x96\xCE\xB1\xFF\x80";
+    auto random = std::mt19937{ seed };
+    auto byte = std::uniform_int_distribution<std::size_t>{ 0, std::size(BYTES) - 1 };
+    auto length = std::uniform_int_distribution<std::size_t>{ 0, 48 };
+    auto input = std::string{};
+    for (std::size_t run = 0; run < runs; ++run)
+    {
+        input.resize(length(random));
+        for (auto& c : input)
+            c = BYTES[byte(random)];
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(std::data(input)), std::size(input));
+    }
+    std::cerr << runs << " random inputs, no mismatch\n";
+}
+#endif
@@ -0,0 +1,164 @@
+#include "catch.hpp"
+
+#include "../batch_encode.hpp"
+#include "../multi_key.hpp"
+#include "../soundex.hpp"
+#include "../unicode.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST_CASE("Test Unicode input", "[Unicode]")
+{
+    SECTION("Checks for ASCII in blocks and in the tail")
+    {
+        CHECK(Unicode::IsAscii(""));
+        CHECK(Unicode::IsAscii("Robert"));
+        CHECK(Unicode::IsAscii("Wolfeschlegelsteinhausenbergerdorff"));
+        CHECK_FALSE(Unicode::IsAscii("Müller"));
+        CHECK_FALSE(Unicode::IsAscii("Wolfeschlegelsteinhausenbergerdorfé"));
+        CHECK_FALSE(Unicode::IsAscii("Ångström-Wolfeschlegelsteinhausen"));
+        CHECK_FALSE(Unicode::IsAscii("Wolfeschlegel\xffsteinhausen"));
+    }
+
+    SECTION("Folds Latin letters to ASCII")
+    {
+        CHECK(Unicode::FoldToAscii("Müller") == "Muller");
+        CHECK(Unicode::FoldToAscii("ÑÚÑEZ") == "NUNEZ");
+        CHECK(Unicode::FoldToAscii("Łukasz") == "Lukasz");
+        CHECK(Unicode::FoldToAscii("Straße") == "Strasse");
+        CHECK(Unicode::FoldToAscii("Ærøskøbing") == "AEroskobing");
+        CHECK(Unicode::FoldToAscii("Dvořák") == "Dvorak");
+        CHECK(Unicode::FoldToAscii("a×b") == std::nullopt);
+    }
+
+    SECTION("Transliterates Greek and Cyrillic letters")
+    {
+        CHECK(Unicode::FoldToAscii("Щербаков") == "SHCHerbakov");
+        CHECK(Unicode::FoldToAscii("Игорь") == "Igor");
+        CHECK(Unicode::FoldToAscii("ЮЛИЯ") == "YULIYA");
+        CHECK(Unicode::FoldToAscii("Їжак") == "YIzhak");
+        CHECK(Unicode::FoldToAscii("Ђорђевић") == "DJordjevic");
+        CHECK(Unicode::FoldToAscii("Παπαδόπουλος") == "Papadopoylos");
+        CHECK(Unicode::FoldToAscii("ΘΕΟΔΩΡΟΥ") == "THEODOROY");
+        CHECK(Unicode::FoldToAscii("Ψυχάρης") == "PSycharis");
+        CHECK(Unicode::FoldToAscii("Ь") == "");
+        CHECK(Unicode::FoldToAscii("Ива·нов") == std::nullopt);
+        CHECK(Unicode::FoldToAscii("李") == std::nullopt);
+    }
+
+    SECTION("Rejects malformed UTF-8")
+    {
+        CHECK(Unicode::FoldToAscii("M\xfcller") == std::nullopt);
+        CHECK(Unicode::FoldToAscii("M\xc3") == std::nullopt);
+        CHECK(Unicode::FoldToAscii("\xc1\x81") == std::nullopt);
+        CHECK(Unicode::FoldToAscii("\xed\xa0\x80") == std::nullopt);
+    }
+
+    SECTION("Encodes accented names like their base letters")
+    {
+        CHECK(Soundex::Encode("Müller") == "M460");
+        CHECK(Soundex::Encode("Ñúñez") == "N520");
+        CHECK(Soundex::Encode("Łukasz") == "L220");
+        CHECK(Soundex::Encode("Strauß") == Soundex::Encode("Strauss"));
+        CHECK(Soundex::EncodeExtended("Dvořáková", 6) == "D16210");
+        CHECK(Soundex::EncodePacked("Müller") == Soundex::EncodePacked("Muller"));
+        CHECK(Soundex::EncodePacked("Łukasz") == Soundex::EncodePacked("Lukasz"));
+        CHECK(BasicSoundex<4, SoundexRules::American>::Encode("Ñúñez") == BasicSoundex<4, SoundexRules::American>::Encode("Nunez"));
+    }
+
+    SECTION("Encodes Greek and Cyrillic names like their transliterations")
+    {
+        CHECK(Soundex::Encode("Иванов") == Soundex::Encode("Ivanov"));
+        CHECK(Soundex::Encode("Щербаков") == Soundex::Encode("Shcherbakov"));
+        CHECK(Soundex::EncodePacked("Παπαδόπουλος") == Soundex::EncodePacked("Papadopoulos"));
+        CHECK(Soundex::EncodeExtended("Хрущёв", 6) == Soundex::EncodeExtended("Khrushchev", 6));
+    }
+
+    SECTION("Rejects names with other characters")
+    {
+        CHECK_THROWS(Soundex::Encode("李"));
+        CHECK_THROWS(Soundex::Encode("Ь"));
+        CHECK_THROWS(Soundex::Encode("M\xfcller"));
+        CHECK_FALSE(Soundex::TryEncodePacked("Müller\xc3").has_value());
+    }
+
+    SECTION("Folds names for every key")
+    {
+        auto keys = MultiKey::Keys<>{};
+        REQUIRE(MultiKey::EncodeInto("Müller", keys));
+        auto expected = MultiKey::Keys<>{};
+        REQUIRE(MultiKey::EncodeInto("Muller", expected));
+        CHECK(keys.soundex == expected.soundex);
+        CHECK(keys.long_soundex == expected.long_soundex);
+        CHECK(keys.metaphone.primary == expected.metaphone.primary);
+        CHECK_FALSE(MultiKey::EncodeInto("李", keys));
+
+        // Longer than the buffer the letters are folded into
+        auto long_name = std::string{};
+        auto long_folded = std::string{};
+        for (int i = 0; i < 100; ++i)
+        {
+            long_name += "Schröder";
+            long_folded += "Schroder";
+        }
+        REQUIRE(MultiKey::EncodeInto(long_name, keys));
+        REQUIRE(MultiKey::EncodeInto(long_folded, expected));
+        CHECK(keys.long_soundex == expected.long_soundex);
+        CHECK(keys.metaphone.primary == expected.metaphone.primary);
+        CHECK(keys.metaphone.alternate == expected.metaphone.alternate);
+    }
+}
+
+TEST_CASE("Test wide character input", "[Unicode]")
+{
+    SECTION("Checks wide text for ASCII")
+    {
+        CHECK(Unicode::IsAscii(std::u16string_view{ u"Wolfeschlegelsteinhausenbergerdorff" }));
+        CHECK(Unicode::IsAscii(std::u32string_view{ U"Wolfeschlegelsteinhausenbergerdorff" }));
+        CHECK(Unicode::IsAscii(std::wstring_view{ L"Robert" }));
+        CHECK_FALSE(Unicode::IsAscii(std::u16string_view{ u"Wolfeschlegelsteinhausenbergerdorfé" }));
+        CHECK_FALSE(Unicode::IsAscii(std::u16string_view{ u"Wolfeschlegel\u0100steinhausen" }));
+        CHECK_FALSE(Unicode::IsAscii(std::u32string_view{ U"Ωlfeschlegelsteinhausenbergerdorff" }));
+        CHECK_FALSE(Unicode::IsAscii(std::wstring_view{ L"Müller" }));
+    }
+
+    SECTION("Decodes UTF-16 surrogate pairs and rejects unpaired ones")
+    {
+        CHECK(Unicode::FoldToAscii(std::u16string_view{ u"Щербаков" }) == "SHCHerbakov");
+        CHECK(Unicode::FoldToAscii(std::u16string_view{ u"Mu\U0001D4C1ler" }) == std::nullopt);
+        const auto unpaired = std::u16string{ u'M', char16_t{ 0xD835 }, u'u' };
+        CHECK(Unicode::FoldToAscii(std::u16string_view{ unpaired }) == std::nullopt);
+        const auto reversed = std::u16string{ char16_t{ 0xDCC1 }, char16_t{ 0xD835 } };
+        CHECK(Unicode::FoldToAscii(std::u16string_view{ reversed }) == std::nullopt);
+        const auto out_of_range = std::u32string{ U'M', char32_t{ 0x110000 } };
+        CHECK(Unicode::FoldToAscii(std::u32string_view{ out_of_range }) == std::nullopt);
+    }
+
+    SECTION("Encodes wide names like UTF-8 ones")
+    {
+        for (const auto& [narrow, wide] : { std::pair{ "Robert", u"Robert" }, std::pair{ "Müller", u"Müller" },
+                                           std::pair{ "Иванов", u"Иванов" }, std::pair{ "Ψυχάρης", u"Ψυχάρης" } })
+        {
+            CHECK(Soundex::TryEncodePacked(std::u16string_view{ wide }) == Soundex::TryEncodePacked(narrow));
+        }
+        CHECK(Soundex::TryEncodePacked(std::u32string_view{ U"Łukasz" }) == Soundex::TryEncodePacked("Lukasz"));
+        CHECK(Soundex::TryEncodePacked(std::wstring_view{ L"Ñúñez" }) == Soundex::TryEncodePacked("Nunez"));
+        CHECK_FALSE(Soundex::TryEncodePacked(std::u16string_view{ u"李" }).has_value());
+#if defined(__cpp_char8_t)
+        CHECK(Soundex::TryEncodePacked(std::u8string_view{ u8"Müller" }) == Soundex::TryEncodePacked("Muller"));
+#endif
+    }
+
+    SECTION("Encodes a column of UTF-16 names in place")
+    {
+        const auto narrow = std::vector<std::string_view>{ "Robert", "Müller", "李", "Иванов", "Rupert" };
+        const auto wide = std::vector<std::u16string_view>{ u"Robert", u"Müller", u"李", u"Иванов", u"Rupert" };
+        const auto expected = BatchEncode::EncodeColumn<Soundex>(narrow);
+        const auto column = BatchEncode::EncodeColumn<Soundex>(wide, 2);
+        CHECK(column.codes == expected.codes);
+        CHECK(column.offsets == expected.offsets);
+        CHECK(column.rejected == 1);
+    }
+}
@@ -0,0 +1,310 @@
+//
+// Unicode input for the encoders: decoding UTF-8, UTF-16 and UTF-32, and
+// transliterating letters to ASCII.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Unicode
+{
+    inline constexpr char32_t INVALID{ 0xFFFFFFFF };
+
+    // Text is UTF-8 in char (and char8_t), UTF-16 in char16_t, UTF-32 in char32_t,
+    // and UTF-16 or UTF-32 in wchar_t depending on its size
+    template <typename CharT>
+    using Text = std::basic_string_view<CharT>;
+
+    namespace Detail
+    {
+        template <typename CharT>
+        auto CodeUnit(CharT c) -> std::uint32_t
+        {
+            return static_cast<std::make_unsigned_t<CharT>>(c);
+        }
+
+        // The bits of an ASCII code unit that are 0, over 8 bytes of code units
+        template <typename CharT>
+        constexpr auto NonAsciiMask() -> std::uint64_t
+        {
+            auto mask = std::uint64_t{ 0 };
+            for (std::size_t i = 0; i < 8 / sizeof(CharT); ++i)
+                mask = (mask << (8 * sizeof(CharT))) | (((std::uint64_t{ 1 } << (8 * sizeof(CharT))) - 1) & ~std::uint64_t{ 0x7F });
+            return mask;
+        }
+
+        template <typename CharT>
+        auto DecodeUtf8(Text<CharT> text, std::size_t& position) -> char32_t
+        {
+            const auto lead = CodeUnit(text[position++]);
+            if (lead < 0x80)
+                return lead;
+            auto size = std::size_t{ 0 };
+            auto code_point = char32_t{ 0 };
+            auto minimum = char32_t{ 0 };
+            if ((lead & 0xE0u) == 0xC0u)
+            {
+                size = 1;
+                code_point = lead & 0x1Fu;
+                minimum = 0x80;
+            }
+            else if ((lead & 0xF0u) == 0xE0u)
+            {
+                size = 2;
+                code_point = lead & 0x0Fu;
+                minimum = 0x800;
+            }
+            else if ((lead & 0xF8u) == 0xF0u)
+            {
+                size = 3;
+                code_point = lead & 0x07u;
+                minimum = 0x10000;
+            }
+            else
+            {
+                return INVALID;
+            }
+            if (position + size > std::size(text))
+                return INVALID;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const auto continuation = CodeUnit(text[position + i]);
+                if ((continuation & 0xC0u) != 0x80u)
+                    return INVALID;
+                code_point = (code_point << 6) | (continuation & 0x3Fu);
+            }
+            if (code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+                return INVALID;
+            position += size;
+            return code_point;
+        }
+
+        template <typename CharT>
+        auto DecodeUtf16(Text<CharT> text, std::size_t& position) -> char32_t
+        {
+            const auto unit = CodeUnit(text[position++]);
+            if (unit < 0xD800 || unit > 0xDFFF)
+                return unit;
+            if (unit > 0xDBFF || position == std::size(text))
+                return INVALID;
+            const auto low = CodeUnit(text[position]);
+            if (low < 0xDC00 || low > 0xDFFF)
+                return INVALID;
+            ++position;
+            return 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        template <typename CharT>
+        auto DecodeUtf32(Text<CharT> text, std::size_t& position) -> char32_t
+        {
+            const auto unit = CodeUnit(text[position++]);
+            if (unit > 0x10FFFF || (unit >= 0xD800 && unit <= 0xDFFF))
+                return INVALID;
+            return unit;
+        }
+    } // namespace Detail
+
+    // Whether text is pure ASCII, 16 bytes at a time with SSE2 and 8 at a time
+    // otherwise, whatever the code unit size. Most names are, and take the encoders'
+    // code unit by code unit path.
+    template <typename CharT>
+    auto IsAscii(Text<CharT> text) -> bool
+    {
+        constexpr auto MASK = Detail::NonAsciiMask<CharT>();
+        constexpr auto UNITS = 8 / sizeof(CharT);
+        const auto* data = std::data(text);
+        auto size = std::size(text);
+#if defined(__SSE2__)
+        const auto mask = _mm_set1_epi64x(static_cast<long long>(MASK));
+        for (; size >= 2 * UNITS; data += 2 * UNITS, size -= 2 * UNITS)
+        {
+            const auto units = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), mask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(units, _mm_setzero_si128())) != 0xFFFF)
+                return false;
+        }
+#endif
+        for (; size >= UNITS; data += UNITS, size -= UNITS)
+        {
+            auto units = std::uint64_t{ 0 };
+            std::memcpy(&units, data, sizeof(units));
+            if ((units & MASK) != 0)
+                return false;
+        }
+        for (; size > 0; ++data, --size)
+            if (Detail::CodeUnit(*data) >= 0x80)
+                return false;
+        return true;
+    }
+
+    inline auto IsAscii(std::string_view text) -> bool
+    {
+        return IsAscii<char>(text);
+    }
+
+    // Code point starting at position, which is moved past it. Returns INVALID for
+    // malformed, overlong or surrogate sequences, and moves one code unit on.
+    template <typename CharT>
+    auto Decode(Text<CharT> text, std::size_t& position) -> char32_t
+    {
+        if constexpr (sizeof(CharT) == 1)
+            return Detail::DecodeUtf8(text, position);
+        else if constexpr (sizeof(CharT) == 2)
+            return Detail::DecodeUtf16(text, position);
+        else
+            return Detail::DecodeUtf32(text, position);
+    }
+
+    namespace Detail
+    {
+        // A block of code points and the ASCII letters each is transliterated to, WIDTH
+        // characters per code point padded with '_'. An entry of only '_' is a letter
+        // that is not written (the Cyrillic hard and soft signs), and one starting with
+        // '*' is not a letter.
+        struct Script
+        {
+            char32_t begin;
+            char32_t end;
+            std::size_t width;
+            std::string_view letters;
+        };
+
+        // U+00C0 to U+017F, Latin-1 Supplement letters and Latin Extended-A. Accents
+        // are dropped, ligatures and the letters English spells with two are spelled
+        // out ('ß' is "ss", 'Þ' is "TH"), and '×' and '÷' are not letters.
+        inline constexpr Script LATIN{ 0xC0, 0x180, 2,
+                                       "A_A_A_A_A_A_AEC_E_E_E_E_I_I_I_I_" // U+00C0
+                                       "D_N_O_O_O_O_O_*_O_U_U_U_U_Y_THss" // U+00D0
+                                       "a_a_a_a_a_a_aec_e_e_e_e_i_i_i_i_" // U+00E0
+                                       "d_n_o_o_o_o_o_*_o_u_u_u_u_y_thy_" // U+00F0
+                                       "A_a_A_a_A_a_C_c_C_c_C_c_C_c_D_d_" // U+0100
+                                       "D_d_E_e_E_e_E_e_E_e_E_e_G_g_G_g_" // U+0110
+                                       "G_g_G_g_H_h_H_h_I_i_I_i_I_i_I_i_" // U+0120
+                                       "I_i_IJijJ_j_K_k_k_L_l_L_l_L_l_L_" // U+0130
+                                       "l_L_l_N_n_N_n_N_n_n_N_n_O_o_O_o_" // U+0140
+                                       "O_o_OEoeR_r_R_r_R_r_S_s_S_s_S_s_" // U+0150
+                                       "S_s_T_t_T_t_T_t_U_u_U_u_U_u_U_u_" // U+0160
+                                       "U_u_U_u_W_w_Y_y_Y_Z_z_Z_z_Z_z_s_" // U+0170
+        };
+
+        // U+0386 to U+03CF, the modern Greek letters, as in ELOT 743
+        inline constexpr Script GREEK{ 0x386, 0x3D0, 2,
+                                       "A_*_E_I_I_*_O_*_Y_O_" // U+0386
+                                       "i_A_V_G_D_E_Z_I_THI_K_L_M_N_X_O_" // U+0390
+                                       "P_R_*_S_T_Y_F_CHPSO_I_Y_a_e_i_i_" // U+03A0
+                                       "y_a_v_g_d_e_z_i_thi_k_l_m_n_x_o_" // U+03B0
+                                       "p_r_s_s_t_y_f_chpso_i_y_o_y_o_*_" // U+03C0
+        };
+
+        // U+0400 to U+045F, Russian, Ukrainian, Belarusian, Serbian and Macedonian
+        // Cyrillic, in the BGN/PCGN spellings without diacritics
+        inline constexpr Script CYRILLIC{ 0x400, 0x460, 4,
+                                          "E___YO__DJ__G___YE__DZ__I___YI__" // U+0400
+                                          "J___LJ__NJ__C___K___I___U___DZ__"
+                                          "A___B___V___G___D___E___ZH__Z___" // U+0410
+                                          "I___Y___K___L___M___N___O___P___"
+                                          "R___S___T___U___F___KH__TS__CH__" // U+0420
+                                          "SH__SHCH____Y_______E___YU__YA__"
+                                          "a___b___v___g___d___e___zh__z___" // U+0430
+                                          "i___y___k___l___m___n___o___p___"
+                                          "r___s___t___u___f___kh__ts__ch__" // U+0440
+                                          "sh__shch____y_______e___yu__ya__"
+                                          "e___yo__dj__g___ye__dz__i___yi__" // U+0450
+                                          "j___lj__nj__c___k___i___u___dz__"
+        };
+
+        static_assert(std::size(LATIN.letters) == LATIN.width * (LATIN.end - LATIN.begin));
+        static_assert(std::size(GREEK.letters) == GREEK.width * (GREEK.end - GREEK.begin));
+        static_assert(std::size(CYRILLIC.letters) == CYRILLIC.width * (CYRILLIC.end - CYRILLIC.begin));
+
+        // The ASCII letters of a code point past ASCII, maybe none, or std::nullopt if
+        // it is not a letter of the scripts above
+        inline auto Transliterate(char32_t code_point) -> std::optional<std::string_view>
+        {
+            for (const auto& script : { LATIN, GREEK, CYRILLIC })
+            {
+                if (code_point < script.begin || code_point >= script.end)
+                    continue;
+                auto letters = script.letters.substr(script.width * (code_point - script.begin), script.width);
+                if (letters.front() == '*')
+                    return std::nullopt;
+                return letters.substr(0, letters.find('_'));
+            }
+            return std::nullopt;
+        }
+    } // namespace Detail
+
+    // What Letters::Next returns at the end of the text, and for a code point that is
+    // not a letter
+    inline constexpr int END{ -1 };
+    inline constexpr int NOT_A_LETTER{ 0xFF };
+
+    // Reads the ASCII letters a name transliterates to, one at a time, without making
+    // a transliterated copy. ASCII is passed through, Latin letters are folded and
+    // Greek and Cyrillic ones spelled out; other code points give NOT_A_LETTER, for
+    // the encoder to reject.
+    template <typename CharT>
+    class Letters
+    {
+    public:
+        explicit Letters(Text<CharT> text) : text_{ text }
+        {
+        }
+
+        auto Next() -> int
+        {
+            while (pending_.empty())
+            {
+                if (position_ == std::size(text_))
+                    return END;
+                const auto code_point = Decode(text_, position_);
+                if (code_point < 0x80)
+                    return static_cast<int>(code_point);
+                const auto letters = Detail::Transliterate(code_point);
+                if (!letters.has_value())
+                    return NOT_A_LETTER;
+                pending_ = *letters;
+            }
+            const auto letter = pending_.front();
+            pending_.remove_prefix(1);
+            return static_cast<unsigned char>(letter);
+        }
+
+    private:
+        Text<CharT> text_;
+        std::size_t position_{ 0 };
+        // Letters of the last code point not read yet
+        std::string_view pending_;
+    };
+
+    // The ASCII spelling of text, or std::nullopt if it has code points that are not
+    // letters of the scripts above
+    template <typename CharT>
+    auto FoldToAscii(Text<CharT> text) -> std::optional<std::string>
+    {
+        auto folded = std::string{};
+        folded.reserve(std::size(text));
+        auto letters = Letters<CharT>{ text };
+        for (auto letter = letters.Next(); letter != END; letter = letters.Next())
+        {
+            if (letter == NOT_A_LETTER)
+                return std::nullopt;
+            folded.push_back(static_cast<char>(letter));
+        }
+        return folded;
+    }
+
+    inline auto FoldToAscii(std::string_view text) -> std::optional<std::string>
+    {
+        return FoldToAscii<char>(text);
+    }
+} // namespace Unicode